@@ -0,0 +1,511 @@
+// Microbenchmarks for the engine hot paths. Each case runs over generated
+// data and prints one JSON object into a result array on stdout.
+//
+//   bench [filter]       e.g. "bench ResolveCollisions"
+//
+// The engine sources are compiled into this file, so MAX_ENTITIES can be
+// raised and the allocator hooked; every engine .c is included below.
+
+#define MAX_ENTITIES 100000
+
+#include <stddef.h>
+#include <stdlib.h>
+static size_t benchAllocs;
+static size_t benchBytes;
+
+static void* BenchMalloc(size_t size) { benchAllocs++; benchBytes += size; return malloc(size); }
+static void* BenchRealloc(void* p, size_t size) { benchAllocs++; benchBytes += size; return realloc(p, size); }
+
+#define ENGINE_MALLOC(size) BenchMalloc(size)
+#define ENGINE_REALLOC(ptr, size) BenchRealloc(ptr, size)
+#define ENGINE_FREE(ptr) free(ptr)
+
+#include "engine.c"
+#include "level_text.c"
+#include "level_binary.c"
+#include "level_cache.c"
+#include "level_reload.c"
+#include "level_watch.c"
+#include "level_sequence.c"
+#include "level_chunks.c"
+#include "level_pack.c"
+#include "level_validate.c"
+#include "simulation.c"
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_MIN_SECONDS 0.2
+
+// --- HARNESS ---
+typedef struct BenchResult {
+    const char* name;
+    long long n;            // Scale parameter: entities or snake length
+    long long ops;          // Timed operations
+    double seconds;
+    size_t allocs;
+    size_t bytes;
+    int eventHighWater;     // Longest event queue seen, 0 if the case queues none
+} BenchResult;
+
+static const char* benchFilter;
+static bool firstResult = true;
+static bool benchFailed;
+
+static double NowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static bool Selected(const char* name) {
+    return !benchFilter || strstr(name, benchFilter) != NULL;
+}
+
+static void Report(BenchResult r) {
+    double nsPerOp = r.ops ? r.seconds * 1e9 / r.ops : 0.0;
+    double opsPerSec = r.seconds > 0 ? r.ops / r.seconds : 0.0;
+    printf("%s  {\"name\": \"%s\", \"n\": %lld, \"ops\": %lld, \"ns_per_op\": %.2f, \"ops_per_sec\": %.0f, "
+           "\"allocs_per_op\": %.4f, \"bytes_per_op\": %.1f",
+           firstResult ? "" : ",\n", r.name, r.n, r.ops, nsPerOp, opsPerSec,
+           r.ops ? (double)r.allocs / r.ops : 0.0, r.ops ? (double)r.bytes / r.ops : 0.0);
+    printf(", \"event_high_water\": %d}", r.eventHighWater);
+    firstResult = false;
+    fflush(stdout);
+}
+
+// A case that couldn't run still gets a result, so a broken loader doesn't
+// pass for a fast one; main then exits non-zero
+static void ReportError(const char* name, long long n, const char* error) {
+    printf("%s  {\"name\": \"%s\", \"n\": %lld, \"error\": \"%s\"}", firstResult ? "" : ",\n", name, n, error);
+    firstResult = false;
+    benchFailed = true;
+    fflush(stdout);
+}
+
+static void ResetAllocCounters(void) {
+    benchAllocs = 0;
+    benchBytes = 0;
+}
+
+// --- DATA GENERATION ---
+static unsigned int rngState;
+
+static unsigned int NextRandom(void) {
+    rngState = rngState * 1664525u + 1013904223u;
+    return rngState >> 8;
+}
+
+// Levels are a strip of screens, about 100 entities per screen, so density
+// stays that of a hand-made level however large n gets
+static int ScreensFor(int n) {
+    return n / 100 + 1;
+}
+
+static Vector2 RandomCell(int screens) {
+    int screen = (int)(NextRandom() % (unsigned int)screens);
+    return (Vector2){ (float)(screen * SCREEN_W + (int)(NextRandom() % GRID_COLS) * CELL_SIZE), (float)(NextRandom() % GRID_ROWS) * CELL_SIZE };
+}
+
+// One snake on the first screen plus n-1 walls, pickups and enemies on random
+// cells. Walls are 1-4 cells per side, like hand-made levels.
+static void GenerateLevel(GameState* state, int n) {
+    LoadLevel(state, "/dev/null");
+    rngState = 12345u;
+    int screens = ScreensFor(n);
+    state->worldSize = (Vector2){ (float)screens * SCREEN_W, SCREEN_H };
+
+    EntityHandle snake = SpawnEntity(state, ENTITY_SNAKE, (Vector2){400, 300}, (Vector2){CELL_SIZE, CELL_SIZE});
+    SnakeData* s = AttachSnake(state, snake.index);
+    InitSnake(s, state->positions[snake.index], &state->levelArena, TOTAL_CELLS, &state->occupancy);
+
+    for (int i = 1; i < n; i++) {
+        unsigned int kind = NextRandom() % 10;
+        Vector2 pos = RandomCell(screens);
+        if (kind < 5) {
+            Vector2 size = { (float)(1 + NextRandom() % 4) * CELL_SIZE, (float)(1 + NextRandom() % 4) * CELL_SIZE };
+            SpawnEntity(state, ENTITY_WALL, pos, size);
+        } else if (kind < 8) {
+            EntityType type = (kind == 7) ? ENTITY_COIN : ENTITY_APPLE;
+            EntityHandle h = SpawnEntity(state, type, pos, (Vector2){CELL_SIZE, CELL_SIZE});
+            AttachApple(state, h.index)->value = 10;
+        } else {
+            EntityHandle h = SpawnEntity(state, ENTITY_ENEMY_BASIC, pos, (Vector2){CELL_SIZE, CELL_SIZE});
+            *AttachEnemy(state, h.index) = (EnemyData){ {1, 0}, 0.0f, 0.0f };
+        }
+    }
+}
+
+// editEvery > 0 shifts every editEvery-th entity one cell right (a small edit)
+static void WriteLevelFile(const char* path, int n, int editEvery) {
+    FILE* f = fopen(path, "w");
+    if (!f) return;
+    rngState = 12345u;
+    int screens = ScreensFor(n);
+    fprintf(f, "META TARGET 1000\nMETA SPEED 0.15\nMETA WORLD %d %d\nP 400 300\n", screens * SCREEN_W, SCREEN_H);
+    for (int i = 1; i < n; i++) {
+        unsigned int kind = NextRandom() % 10;
+        Vector2 pos = RandomCell(screens);
+        if (editEvery > 0 && i % editEvery == 0) pos.x += CELL_SIZE;
+        if (kind < 5) fprintf(f, "W %d %d %u %u\n", (int)pos.x, (int)pos.y, (1 + NextRandom() % 4) * CELL_SIZE, (1 + NextRandom() % 4) * CELL_SIZE);
+        else if (kind < 8) fprintf(f, "%c %d %d %d %d 10\n", kind == 7 ? 'C' : 'A', (int)pos.x, (int)pos.y, CELL_SIZE, CELL_SIZE);
+        else fprintf(f, "E %d %d %d %d 0 1 1.5\n", (int)pos.x, (int)pos.y, CELL_SIZE, CELL_SIZE);
+    }
+    fclose(f);
+}
+
+// --- CASES ---
+static const int snakeLengths[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+static const int entityCounts[] = { 10, 100, 1000, 10000, 100000 };
+#define COUNT_OF(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+static void BenchMoveSnake(void) {
+    if (!Selected("MoveSnake")) return;
+    for (int c = 0; c < COUNT_OF(snakeLengths); c++) {
+        int length = snakeLengths[c];
+        SnakeData s;
+        InitSnake(&s, (Vector2){400, 300}, NULL, length, NULL);
+        for (int i = 1; i < length; i++) AppendSnake(&s, (Vector2){400, 300});
+
+        // Bounce left/right so the edge clamp never stalls the move
+        ResetAllocCounters();
+        long long ops = 0;
+        double start = NowSeconds(), elapsed = 0.0;
+        while (elapsed < BENCH_MIN_SECONDS) {
+            for (int i = 0; i < 4096; i++) {
+                s.direction = (Vector2){ (i & 1) ? -1.0f : 1.0f, 0 };
+                MoveSnake(&s, (Vector2){ SCREEN_W, SCREEN_H });
+            }
+            ops += 4096;
+            elapsed = NowSeconds() - start;
+        }
+        Report((BenchResult){ "MoveSnake", length, ops, elapsed, benchAllocs, benchBytes, 0 });
+        ENGINE_FREE(s.body);
+    }
+}
+
+static void BenchAppendSnake(void) {
+    if (!Selected("AppendSnake")) return;
+    for (int c = 0; c < COUNT_OF(snakeLengths); c++) {
+        int length = snakeLengths[c];
+        long long ops = 0;
+        double elapsed = 0.0;
+        ResetAllocCounters();
+        while (elapsed < BENCH_MIN_SECONDS) {
+            SnakeData s;
+            InitSnake(&s, (Vector2){400, 300}, NULL, 1, NULL);
+            double start = NowSeconds();
+            for (int i = 1; i < length; i++) AppendSnake(&s, (Vector2){400, 300});
+            elapsed += NowSeconds() - start;
+            ops += length - 1 > 0 ? length - 1 : 1;
+            ENGINE_FREE(s.body);
+        }
+        Report((BenchResult){ "AppendSnake", length, ops, elapsed, benchAllocs, benchBytes, 0 });
+    }
+}
+
+static void BenchResolveCollisions(GameState* state, bool brute) {
+    const char* name = brute ? "ResolveCollisions/brute" : "ResolveCollisions/grid";
+    if (!Selected(name)) return;
+    for (int c = 0; c < COUNT_OF(entityCounts); c++) {
+        int n = entityCounts[c];
+        if (brute && n > 10000) break; // Quadratic; 100k would take minutes per call
+        GenerateLevel(state, n);
+        // A pickup under the head, so the grid pass runs rather than the
+        // no-contact early out
+        EntityHandle bait = SpawnEntity(state, ENTITY_APPLE, (Vector2){400, 300}, (Vector2){CELL_SIZE, CELL_SIZE});
+        AttachApple(state, bait.index)->value = 10;
+        state->bruteForceCollisions = brute;
+        ResolveCollisions(state);   // Warm-up sizes the broadphase buffers
+        ClearEventQueue(&state->events);
+
+        ResetAllocCounters();
+        long long ops = 0;
+        double start = NowSeconds(), elapsed = 0.0;
+        while (elapsed < BENCH_MIN_SECONDS) {
+            ResolveCollisions(state);
+            ClearEventQueue(&state->events);
+            ops++;
+            elapsed = NowSeconds() - start;
+        }
+        Report((BenchResult){ name, n, ops, elapsed, benchAllocs, benchBytes, state->events.highWater });
+    }
+}
+
+// Each op is one queued snake-vs-pickup event: eat, grow, destroy the pickup
+static void BenchProcessEvents(GameState* state) {
+    if (!Selected("ProcessEvents")) return;
+    for (int c = 0; c < COUNT_OF(entityCounts); c++) {
+        int n = entityCounts[c];
+        long long ops = 0;
+        double elapsed = 0.0;
+        size_t allocs = 0, bytes = 0;
+        while (elapsed < BENCH_MIN_SECONDS) {
+            GenerateLevel(state, n);
+            EntityHandle snake = HandleOf(state, state->snakeOwner[0]);
+            for (int k = 0; k < state->appleCount; k++) {
+                EntityHandle apple = HandleOf(state, state->appleOwner[k]);
+                PushEvent(state, (Event){ .type = EVENT_COLLISION, .collision = { snake, apple } });
+            }
+            int queued = state->events.count;
+
+            ResetAllocCounters();
+            double start = NowSeconds();
+            ProcessEvents(state);
+            elapsed += NowSeconds() - start;
+            allocs += benchAllocs;
+            bytes += benchBytes;
+            ops += queued;
+        }
+        Report((BenchResult){ "ProcessEvents", n, ops, elapsed, allocs, bytes, state->events.highWater });
+    }
+}
+
+// Workers queue a snake-vs-pickup event for each pickup in their slice of the
+// alive list, as a split narrowphase would
+typedef struct EventFillJob {
+    const GameState* state;
+    int begin, end;
+    EventQueue queue;
+} EventFillJob;
+
+static void* FillEvents(void* arg) {
+    EventFillJob* job = (EventFillJob*)arg;
+    const GameState* state = job->state;
+    EntityHandle snake = HandleOf(state, state->snakeOwner[0]);
+    for (int k = job->begin; k < job->end; k++) {
+        int id = state->alive[k];
+        if (state->types[id] != ENTITY_APPLE && state->types[id] != ENTITY_COIN) continue;
+        QueueEvent(&job->queue, (Event){ .type = EVENT_COLLISION, .collision = { snake, HandleOf(state, id) } });
+    }
+    return NULL;
+}
+
+static bool SameEvents(const EventQueue* a, const EventQueue* b) {
+    if (a->count != b->count) return false;
+    for (int i = 0; i < a->count; i++) {
+        const Event* x = &a->items[i];
+        const Event* y = &b->items[i];
+        if (x->type != y->type || x->collision.a.index != y->collision.a.index || x->collision.b.index != y->collision.b.index ||
+            x->collision.a.generation != y->collision.a.generation || x->collision.b.generation != y->collision.b.generation) return false;
+    }
+    return true;
+}
+
+// Each op is one event through a parallel fill and MergeEventQueues. The
+// merged queue must match the single-threaded one at every thread count.
+static void BenchMergeEvents(GameState* state) {
+    static const char* names[] = { "MergeEventQueues/1", "MergeEventQueues/2", "MergeEventQueues/4" };
+    static const int threadCounts[] = { 1, 2, 4 };
+    if (!Selected("MergeEventQueues")) return;
+    EventFillJob jobs[4] = {0};
+    EventQueue* parts[4];
+    EventQueue merged = {0}, reference = {0};
+    for (int c = 0; c < COUNT_OF(entityCounts); c++) {
+        int n = entityCounts[c];
+        GenerateLevel(state, n);
+        for (int t = 0; t < COUNT_OF(threadCounts); t++) {
+            int threads = threadCounts[t];
+            for (int j = 0; j < threads; j++) {
+                jobs[j].state = state;
+                jobs[j].begin = (int)((long long)state->aliveCount * j / threads);
+                jobs[j].end = (int)((long long)state->aliveCount * (j + 1) / threads);
+                parts[j] = &jobs[j].queue;
+                FillEvents(&jobs[j]);  // Warm-up on this thread sizes the queues
+            }
+            ClearEventQueue(&merged);
+            MergeEventQueues(&merged, parts, threads);
+            if (t == 0) {
+                ClearEventQueue(&reference);
+                for (int i = 0; i < merged.count; i++) QueueEvent(&reference, merged.items[i]);
+            }
+
+            ResetAllocCounters();
+            long long ops = 0;
+            bool same = true;
+            double start = NowSeconds(), elapsed = 0.0;
+            while (elapsed < BENCH_MIN_SECONDS) {
+                pthread_t workers[4];
+                int started = 1;
+                for (; started < threads; started++) {
+                    if (pthread_create(&workers[started], NULL, FillEvents, &jobs[started]) != 0) break;
+                }
+                for (int j = started; j < threads; j++) FillEvents(&jobs[j]);
+                FillEvents(&jobs[0]);
+                for (int j = 1; j < started; j++) pthread_join(workers[j], NULL);
+                ClearEventQueue(&merged);
+                MergeEventQueues(&merged, parts, threads);
+                same = same && SameEvents(&merged, &reference);
+                ops += merged.count;
+                elapsed = NowSeconds() - start;
+            }
+            if (same) Report((BenchResult){ names[t], n, ops, elapsed, benchAllocs, benchBytes, merged.highWater });
+            else ReportError(names[t], n, "merged order depends on the thread count");
+        }
+    }
+    for (int j = 0; j < 4; j++) FreeEventQueue(&jobs[j].queue);
+    FreeEventQueue(&merged);
+    FreeEventQueue(&reference);
+}
+
+// expected is the entity count the load must produce, -1 to only require success
+static void TimeLoads(GameState* state, const char* name, const char* path, int n, int expected) {
+    // Warm-up: page cache and arena sizing
+    if (!LoadLevel(state, path)) { ReportError(name, n, "load failed"); return; }
+    if (expected >= 0 && state->aliveCount != expected) { ReportError(name, n, "wrong entity count"); return; }
+
+    ResetAllocCounters();
+    long long ops = 0;
+    double start = NowSeconds(), elapsed = 0.0;
+    while (elapsed < BENCH_MIN_SECONDS) {
+        LoadLevel(state, path);
+        ops++;
+        elapsed = NowSeconds() - start;
+    }
+    Report((BenchResult){ name, n, ops, elapsed, benchAllocs, benchBytes, 0 });
+}
+
+// The loaded level with one screen per chunk. Only the chunks next to the
+// snake load, so the entity count depends on the layout.
+static bool WriteChunkedLevel(const GameState* state, const char* path) {
+    Entity* records = (Entity*)malloc((size_t)(state->aliveCount ? state->aliveCount : 1) * sizeof(Entity));
+    if (!records) return false;
+    for (int k = 0; k < state->aliveCount; k++) records[k] = EntityRecordOf(state, state->alive[k]);
+    bool ok = SaveLevelChunked(records, state->aliveCount, LevelMetaOf(state), path, SCREEN_W / CELL_SIZE);
+    free(records);
+    return ok;
+}
+
+static void BenchLoadLevel(GameState* state) {
+    if (!Selected("LoadLevel")) return;
+    char path[] = "/tmp/snakebench_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return;
+    close(fd);
+    char binaryPath[sizeof(path) + 8];
+    char chunkedPath[sizeof(path) + 8];
+    char packPath[sizeof(path) + 8];
+    char packedLevel[2 * sizeof(path) + 8];
+    snprintf(binaryPath, sizeof(binaryPath), "%s.engb", path);
+    snprintf(chunkedPath, sizeof(chunkedPath), "%s.engc", path);
+    snprintf(packPath, sizeof(packPath), "%s.engp", path);
+    snprintf(packedLevel, sizeof(packedLevel), "%s:%s", packPath, strrchr(path, '/') + 1);
+
+    for (int c = 0; c < COUNT_OF(entityCounts); c++) {
+        int n = entityCounts[c];
+        WriteLevelFile(path, n, 0);
+        if (Selected("LoadLevel/text")) TimeLoads(state, "LoadLevel/text", path, n, n);
+        if (Selected("LoadLevel/packed")) {
+            const char* levels[] = { path };
+            if (SaveLevelPack(packPath, levels, 1, true)) TimeLoads(state, "LoadLevel/packed", packedLevel, n, n);
+            else ReportError("LoadLevel/packed", n, "pack failed");
+        }
+
+        bool loaded = LoadLevel(state, path);
+        if (Selected("LoadLevel/binary")) {
+            if (loaded && SaveLevelBinary(state, binaryPath, true)) TimeLoads(state, "LoadLevel/binary", binaryPath, n, n);
+            else ReportError("LoadLevel/binary", n, "save failed");
+        }
+        if (Selected("LoadLevel/chunked")) {
+            if (loaded && WriteChunkedLevel(state, chunkedPath)) TimeLoads(state, "LoadLevel/chunked", chunkedPath, n, -1);
+            else ReportError("LoadLevel/chunked", n, "save failed");
+        }
+    }
+    remove(path);
+    remove(binaryPath);
+    remove(chunkedPath);
+    remove(packPath);
+    FreeLevelPacks();
+}
+
+// Each op diffs a level against a copy with 1% of its entities moved,
+// alternating between the two files
+static void BenchHotReload(GameState* state) {
+    if (!Selected("HotReload")) return;
+    char pathA[] = "/tmp/snakebench_XXXXXX";
+    char pathB[] = "/tmp/snakebench_XXXXXX";
+    int fdA = mkstemp(pathA), fdB = mkstemp(pathB);
+    if (fdA >= 0) close(fdA);
+    if (fdB >= 0) close(fdB);
+    if (fdA < 0 || fdB < 0) return;
+
+    LevelReloader reload = {0};
+    for (int c = 0; c < COUNT_OF(entityCounts); c++) {
+        int n = entityCounts[c];
+        WriteLevelFile(pathA, n, 0);
+        WriteLevelFile(pathB, n, 100);
+        LoadLevel(state, pathA);
+        TrackLoadedLevel(&reload, state);
+        ApplyLevelChanges(&reload, state, pathB, NULL); // Warm-up sizes the scratch
+        ApplyLevelChanges(&reload, state, pathA, NULL);
+
+        ResetAllocCounters();
+        long long ops = 0;
+        double start = NowSeconds(), elapsed = 0.0;
+        while (elapsed < BENCH_MIN_SECONDS) {
+            ApplyLevelChanges(&reload, state, (ops & 1) ? pathA : pathB, NULL);
+            ops++;
+            elapsed = NowSeconds() - start;
+        }
+        Report((BenchResult){ "HotReload", n, ops, elapsed, benchAllocs, benchBytes, 0 });
+    }
+    FreeLevelReloader(&reload);
+    remove(pathA);
+    remove(pathB);
+}
+
+static void CountHit(void* user, int id) {
+    (void)id;
+    (*(int*)user)++;
+}
+
+// Each op is a query for one screen's worth of view, as the renderer makes
+static void BenchSpatialQuery(GameState* state) {
+    if (!Selected("SpatialQuery")) return;
+    SpatialIndex index = {0};
+    RenderSnapshot snap = {0};
+    for (int c = 0; c < COUNT_OF(entityCounts); c++) {
+        int n = entityCounts[c];
+        GenerateLevel(state, n);
+        int screens = ScreensFor(n);
+        CaptureSnapshot(&snap, state);
+        snap.level = c;
+        UpdateSpatialIndex(&index, &snap);
+
+        ResetAllocCounters();
+        long long ops = 0;
+        int hits = 0;
+        double start = NowSeconds(), elapsed = 0.0;
+        while (elapsed < BENCH_MIN_SECONDS) {
+            Vector2 view = { (float)(ops % screens) * SCREEN_W, 0 };
+            QuerySpatialIndex(&index, &snap, view, (Vector2){ SCREEN_W, SCREEN_H }, CountHit, &hits);
+            ops++;
+            elapsed = NowSeconds() - start;
+        }
+        Report((BenchResult){ "SpatialQuery", n, ops, elapsed, benchAllocs, benchBytes, 0 });
+    }
+    FreeSpatialIndex(&index);
+    FreeSnapshot(&snap);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) benchFilter = argv[1];
+
+    GameState* state = (GameState*)calloc(1, sizeof(GameState));
+    if (!state) return 1;
+
+    printf("[\n");
+    BenchMoveSnake();
+    BenchAppendSnake();
+    BenchResolveCollisions(state, false);
+    BenchResolveCollisions(state, true);
+    BenchProcessEvents(state);
+    BenchMergeEvents(state);
+    BenchLoadLevel(state);
+    BenchHotReload(state);
+    BenchSpatialQuery(state);
+    printf("\n]\n");
+
+    UnloadGameState(state);
+    free(state);
+    return benchFailed ? 1 : 0;
+}
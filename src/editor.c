@@ -2,60 +2,89 @@
 #include "raylib.h"
 #include "raygui.h" 
 #include "game_types.h"
+#include "render.h"
 #include <stdio.h>
 
-// We need a list of entities for the editor, separate from the game simulation
-Entity editorEntities[MAX_ENTITIES];
+// We need a list of entities for the editor, separate from the game simulation.
+// It grows as needed, so levels bigger than MAX_ENTITIES open too.
+Entity* editorEntities = NULL;
 int editorCount = 0;
+int editorCapacity = 0;
+LevelMeta editorMeta = { 999, 0.15f, { SCREEN_W, SCREEN_H } };
 
 // Current selection settings
 int selectedType = ENTITY_WALL; 
 float selectedWidth = 100.0f;
 float selectedHeight = 100.0f;
 
-// --- FILE I/O (WRITER) ---
-void SaveLevel(const char* filename) {
-    FILE* file = fopen(filename, "w");
-    if (!file) {
-        printf("Could not save file to: %s\n", filename);
-        return;
+Entity* AddEditorEntity(void) {
+    if (editorCount == editorCapacity) {
+        int capacity = editorCapacity ? editorCapacity * 2 : 256;
+        Entity* grown = (Entity*)realloc(editorEntities, capacity * sizeof(Entity));
+        if (!grown) return NULL;
+        editorEntities = grown;
+        editorCapacity = capacity;
     }
+    return &editorEntities[editorCount++];
+}
 
-    fprintf(file, "# Generated by C-Engine Editor\n");
-    
-    for (int i = 0; i < editorCount; i++) {
-        Entity* e = &editorEntities[i];
-        if (!e->active) continue;
+Color EditorColor(EntityType type) {
+    switch (type) {
+        case ENTITY_WALL:        return BLUE;
+        case ENTITY_SNAKE:       return GREEN;
+        case ENTITY_APPLE:       return RED;
+        case ENTITY_COIN:        return GOLD;
+        case ENTITY_ENEMY_BASIC: return PURPLE;
+        default:                 return WHITE;
+    }
+}
 
-        // FORMAT: TYPE X Y [W H]
-        if (e->type == ENTITY_SNAKE) {
-            fprintf(file, "P %d %d\n", (int)e->position.x, (int)e->position.y);
-        }
-        else if (e->type == ENTITY_APPLE) {
-            fprintf(file, "A %d %d\n", (int)e->position.x, (int)e->position.y);
-        }
-        else if (e->type == ENTITY_WALL) {
-            fprintf(file, "W %d %d %d %d\n", 
-                (int)e->position.x, (int)e->position.y, 
-                (int)e->size.x, (int)e->size.y);
-        }
+// --- FILE I/O ---
+// Both directions go through the engine, so the editor reads every level
+// format the game does and writes back every type and property it loaded.
+void SaveLevel(const char* filename) {
+    if (!HasExtension(filename, ".eng")) {
+        printf("The editor only saves .eng text levels: %s\n", filename);
+        return;
+    }
+    if (SaveLevelRecords(editorEntities, editorCount, editorMeta, filename)) {
+        printf("Level Saved to %s\n", filename);
     }
+}
 
-    fclose(file);
-    printf("Level Saved to %s\n", filename);
+static void CollectEditorEntity(void* user, const Entity* def) {
+    (void)user;
+    Entity* e = AddEditorEntity();
+    if (e) *e = *def;
 }
 
-void LoadLevelForEditor(const char* filename) {
-    // Logic to load existing levels into editor would go here
+bool LoadLevelForEditor(const char* filename) {
+    // Only .engb and packed levels need a GameState to load through
+    GameState* scratch = (GameState*)calloc(1, sizeof(GameState));
+    if (!scratch) return false;
+
     editorCount = 0;
+    bool ok = ReadLevelRecords(filename, scratch, &editorMeta, CollectEditorEntity, NULL);
+    if (!ok) editorCount = 0;
+    else printf("Opened %s: %d entities\n", filename, editorCount);
+
+    UnloadGameState(scratch);
+    free(scratch);
+    return ok;
 }
 
 // --- MAIN EDITOR LOOP ---
-int main() {
+// Usage: editor [level.eng]   (defaults to assets/level1.eng; a missing file starts empty)
+int main(int argc, char** argv) {
+    const char* levelPath = (argc > 1) ? argv[1] : "assets/level1.eng";
+    LoadLevelForEditor(levelPath);
+
     InitWindow(1000, 600, "Level Editor - Unity Style"); 
     SetTargetFPS(60);
 
     bool showGrid = true;
+    BackgroundLayer background = {0};
+    GridStyle grid = { SCREEN_W, SCREEN_H, CELL_SIZE, BLACK, Fade(WHITE, 0.1f) };
     int activeTool = 0; // 0 = Paint, 1 = Erase
 
     while (!WindowShouldClose()) {
@@ -80,12 +109,11 @@ int main() {
                          }
                     }
 
-                    if (!exists && editorCount < MAX_ENTITIES) {
-                        Entity* e = &editorEntities[editorCount++];
-                        e->active = true;
-                        e->type = selectedType;
-                        e->position = (Vector2){(float)gridX, (float)gridY};
-                        e->size = (Vector2){selectedWidth, selectedHeight};
+                    Entity* e = exists ? NULL : AddEditorEntity();
+                    if (e) {
+                        // Properties start at the loader's defaults
+                        *e = (Entity){ true, (EntityType)selectedType, {(float)gridX, (float)gridY},
+                                       {selectedWidth, selectedHeight}, 10, 1, 0.0f };
                     }
                 }
                 else if (activeTool == 1) {
@@ -102,39 +130,30 @@ int main() {
             }
         }
 
+        // Same baked grid as the game; placed walls are still being edited, so they're drawn live
+        if (showGrid) UpdateBackground(&background, grid, NULL);
+
         BeginDrawing();
         ClearBackground(DARKGRAY);
 
         // Draw Game Area Background
-        DrawRectangle(0, 0, 800, 600, BLACK);
-        
-        // Draw Grid Lines
-        if (showGrid) {
-            for(int i=0; i<800; i+=50) DrawLine(i, 0, i, 600, Fade(WHITE, 0.1f));
-            for(int i=0; i<600; i+=50) DrawLine(0, i, 800, i, Fade(WHITE, 0.1f));
-        }
+        if (showGrid) DrawBackground(&background, (Vector2){0, 0});
+        else DrawRectangle(0, 0, SCREEN_W, SCREEN_H, BLACK);
 
         // Draw Placed Entities
         for (int i = 0; i < editorCount; i++) {
             Entity* e = &editorEntities[i];
             if (!e->active) continue;
 
-            Color c = WHITE;
-            if (e->type == ENTITY_WALL) c = BLUE;
-            if (e->type == ENTITY_SNAKE) c = GREEN;
-            if (e->type == ENTITY_APPLE) c = RED;
-
+            Color c = EditorColor(e->type);
             DrawRectangleV(e->position, e->size, c);
             DrawRectangleLines(e->position.x, e->position.y, e->size.x, e->size.y, WHITE);
         }
 
         // Draw "Ghost" Preview
         if (mousePos.x < 800 && activeTool == 0) {
-            Color ghostColor = WHITE;
-            if (selectedType == ENTITY_WALL) ghostColor = Fade(BLUE, 0.5f);
-            if (selectedType == ENTITY_SNAKE) ghostColor = Fade(GREEN, 0.5f);
-            if (selectedType == ENTITY_APPLE) ghostColor = Fade(RED, 0.5f);
-            
+            Color ghostColor = Fade(EditorColor((EntityType)selectedType), 0.5f);
+
             DrawRectangle(gridX, gridY, (int)selectedWidth, (int)selectedHeight, ghostColor);
         }
 
@@ -162,21 +181,31 @@ int main() {
             selectedType = ENTITY_APPLE;
             selectedWidth = 20; selectedHeight = 20;
         }
+        if (GuiButton((Rectangle){810, 250, 180, 30}, "COIN")) {
+            selectedType = ENTITY_COIN;
+            selectedWidth = 20; selectedHeight = 20;
+        }
+        if (GuiButton((Rectangle){810, 290, 180, 30}, "ENEMY")) {
+            selectedType = ENTITY_ENEMY_BASIC;
+            selectedWidth = 50; selectedHeight = 50;
+        }
 
         // Size Sliders
-        GuiLabel((Rectangle){810, 260, 180, 20}, "Custom Size:");
-        GuiSlider((Rectangle){850, 290, 130, 20}, "W", NULL, &selectedWidth, 20, 500);
-        GuiSlider((Rectangle){850, 320, 130, 20}, "H", NULL, &selectedHeight, 20, 500);
+        GuiLabel((Rectangle){810, 340, 180, 20}, "Custom Size:");
+        GuiSlider((Rectangle){850, 370, 130, 20}, "W", NULL, &selectedWidth, 20, 500);
+        GuiSlider((Rectangle){850, 400, 130, 20}, "H", NULL, &selectedHeight, 20, 500);
 
-        // SAVE BUTTON (Fixed Path)
+        // SAVE BUTTON (back to the file that was opened)
+        GuiLabel((Rectangle){810, 520, 180, 20}, TextFormat("%d entities", editorCount));
         if (GuiButton((Rectangle){810, 550, 180, 40}, "SAVE LEVEL")) {
-            // "assets/" means: Look in the current folder for a folder named assets
-            SaveLevel("assets/level1.eng");
+            SaveLevel(levelPath);
         }
 
         EndDrawing();
     }
 
+    UnloadBackground(&background);
     CloseWindow();
+    free(editorEntities);
     return 0;
 }
\ No newline at end of file
@@ -1,214 +1,1050 @@
 #include "game_types.h"
-#include <string.h> 
+#include <string.h>
+#include <math.h>
+#include <stdarg.h>
+
+// --- LOGGING ---
+// The engine never writes to stdout, which belongs to the program. Problems
+// go to stderr; progress lines go to the log hook, and are dropped until a
+// program sets one. Set it before starting any threads.
+static EngineLogFn engineLog;
+
+void SetEngineLog(EngineLogFn log) {
+    engineLog = log;
+}
+
+void EngineLog(const char* format, ...) {
+    if (!engineLog) return;
+    char message[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    engineLog(message);
+}
+
+void EngineError(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+// --- MEMORY ---
+static ArenaBlock* NewArenaBlock(size_t size) {
+    ArenaBlock* b = (ArenaBlock*)ENGINE_MALLOC(sizeof(ArenaBlock) + size);
+    if (!b) return NULL;
+    b->next = NULL;
+    b->size = size;
+    b->used = 0;
+    return b;
+}
+
+void* ArenaAlloc(Arena* arena, size_t bytes) {
+    bytes = (bytes + 15) & ~(size_t)15;
+    ArenaBlock* b = arena->blocks;
+    if (!b || b->used + bytes > b->size) {
+        size_t size = arena->reserve ? arena->reserve : LEVEL_ARENA_RESERVE;
+        if (b && b->size * 2 > size) size = b->size * 2;
+        if (size < bytes) size = bytes;
+        ArenaBlock* fresh = NewArenaBlock(size);
+        if (!fresh) return NULL;
+        fresh->next = b;
+        arena->blocks = fresh;
+        b = fresh;
+    }
+    void* p = b->data + b->used;
+    b->used += bytes;
+
+    size_t live = 0;
+    for (ArenaBlock* it = arena->blocks; it; it = it->next) live += it->used;
+    if (live > arena->peak) arena->peak = live;
+    return p;
+}
+
+// Frees everything at once. If the last level spilled into extra blocks,
+// they are replaced by one block big enough for the peak, so steady-state
+// reloads reuse the same memory and never call malloc.
+void ArenaReset(Arena* arena) {
+    ArenaBlock* b = arena->blocks;
+    if (b && !b->next && b->size >= arena->peak) {
+        b->used = 0;
+        return;
+    }
+    ArenaFree(arena);
+    size_t size = arena->reserve ? arena->reserve : LEVEL_ARENA_RESERVE;
+    if (arena->peak > size) size = arena->peak;
+    arena->blocks = NewArenaBlock(size);
+}
+
+void ArenaFree(Arena* arena) {
+    ArenaBlock* b = arena->blocks;
+    while (b) {
+        ArenaBlock* next = b->next;
+        ENGINE_FREE(b);
+        b = next;
+    }
+    arena->blocks = NULL;
+}
+
+// --- OCCUPANCY ---
+int CellAt(Vector2 pos) {
+    int cx = (int)floorf(pos.x / CELL_SIZE);
+    int cy = (int)floorf(pos.y / CELL_SIZE);
+    if (cx < 0 || cy < 0 || cx >= GRID_COLS || cy >= GRID_ROWS) return -1;
+    return cy * GRID_COLS + cx;
+}
+
+void OccupancyAdd(OccupancyGrid* g, OccupancyLayer layer, int cell) {
+    if (cell < 0 || g->counts[layer][cell] == OCC_COUNT_MAX) return;
+    if (g->counts[layer][cell]++ == 0) g->bits[layer][cell >> 6] |= 1ull << (cell & 63);
+}
+
+// A saturated count no longer knows how many are left, so it never drops.
+// The cell stays occupied and the narrowphase sorts out what's really there.
+void OccupancyRemove(OccupancyGrid* g, OccupancyLayer layer, int cell) {
+    uint16_t* count = cell >= 0 ? &g->counts[layer][cell] : NULL;
+    if (!count || *count == 0 || *count == OCC_COUNT_MAX) return;
+    if (--*count == 0) g->bits[layer][cell >> 6] &= ~(1ull << (cell & 63));
+}
+
+bool OccupancyTest(const OccupancyGrid* g, OccupancyLayer layer, int cell) {
+    if (cell < 0) return false;
+    return (g->bits[layer][cell >> 6] >> (cell & 63)) & 1;
+}
+
+// Cells touched by [pos, pos + size), unclamped. Returns false if the rect lies partly off-grid.
+static bool RectCells(Vector2 pos, Vector2 size, int* x0, int* y0, int* x1, int* y1) {
+    *x0 = (int)floorf(pos.x / CELL_SIZE);
+    *y0 = (int)floorf(pos.y / CELL_SIZE);
+    *x1 = (int)ceilf((pos.x + size.x) / CELL_SIZE) - 1;
+    *y1 = (int)ceilf((pos.y + size.y) / CELL_SIZE) - 1;
+    if (*x1 < *x0) *x1 = *x0;
+    if (*y1 < *y0) *y1 = *y0;
+    return *x0 >= 0 && *y0 >= 0 && *x1 < GRID_COLS && *y1 < GRID_ROWS;
+}
+
+// Off-grid parts of the rect are ignored; walls hanging off the screen only mark what's visible
+static void OccupancyUpdateRect(OccupancyGrid* g, OccupancyLayer layer, Vector2 pos, Vector2 size, bool add) {
+    int x0, y0, x1, y1;
+    RectCells(pos, size, &x0, &y0, &x1, &y1);
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= GRID_COLS) x1 = GRID_COLS - 1;
+    if (y1 >= GRID_ROWS) y1 = GRID_ROWS - 1;
+    for (int cy = y0; cy <= y1; cy++) {
+        for (int cx = x0; cx <= x1; cx++) {
+            if (add) OccupancyAdd(g, layer, cy * GRID_COLS + cx);
+            else OccupancyRemove(g, layer, cy * GRID_COLS + cx);
+        }
+    }
+}
+
+// Conservative: true if any layer in layerMask covers a cell the rect touches.
+// A rect reaching off the grid can't be answered from the bitboards and reports true.
+bool OccupancyTestRect(const OccupancyGrid* g, unsigned int layerMask, Vector2 pos, Vector2 size) {
+    int x0, y0, x1, y1;
+    if (!RectCells(pos, size, &x0, &y0, &x1, &y1)) return true;
+    for (int cy = y0; cy <= y1; cy++) {
+        for (int cx = x0; cx <= x1; cx++) {
+            int cell = cy * GRID_COLS + cx;
+            for (int layer = 0; layer < OCC_LAYER_COUNT; layer++) {
+                if ((layerMask & OCC_BIT(layer)) && OccupancyTest(g, (OccupancyLayer)layer, cell)) return true;
+            }
+        }
+    }
+    return false;
+}
+
+static int OccupancyLayerOf(EntityType type) {
+    switch (type) {
+        case ENTITY_WALL:        return OCC_WALL;
+        case ENTITY_APPLE:
+        case ENTITY_COIN:        return OCC_FOOD;
+        case ENTITY_ENEMY_BASIC: return OCC_ENEMY;
+        default:                 return -1; // Snakes track their own segments
+    }
+}
 
 // --- SNAKE LOGIC ---
-void InitSnake(SnakeData* s, Vector2 startPos) {
+// The body is a circular buffer indexed from the head, so a move only writes
+// the new head slot; the old tail slot is simply reused on the next wrap.
+static int NextPowerOfTwo(int n) {
+    int p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+static Vector2* AllocBody(Arena* arena, int capacity) {
+    if (arena) return (Vector2*)ArenaAlloc(arena, capacity * sizeof(Vector2));
+    return (Vector2*)ENGINE_MALLOC(capacity * sizeof(Vector2));
+}
+
+// capacity is rounded up to a power of two. Level snakes pass TOTAL_CELLS so
+// they never need to grow while they fit on the playfield.
+void InitSnake(SnakeData* s, Vector2 startPos, Arena* arena, int capacity, OccupancyGrid* occupancy) {
+    s->arena = arena;
+    s->occupancy = occupancy;
+    s->head = 0;
     s->count = 1;
-    s->capacity = 10;
-    s->body = (Vector2*)malloc(s->capacity * sizeof(Vector2));
+    s->capacity = NextPowerOfTwo(capacity > 1 ? capacity : 1);
+    s->body = AllocBody(arena, s->capacity);
     if (s->body) s->body[0] = startPos;
     s->direction = (Vector2){1, 0};
     s->moveTimer = 0.0f;
+    if (occupancy) OccupancyAdd(occupancy, OCC_SNAKE, CellAt(startPos));
 }
 
 void AppendSnake(SnakeData* s, Vector2 newPart) {
     if (s->count >= s->capacity) {
+        int oldCapacity = s->capacity;
         s->capacity *= 2;
-        s->body = (Vector2*)realloc(s->body, s->capacity * sizeof(Vector2));
+        if (s->arena) {
+            // Arena memory can't be resized; copy into a fresh block, unwrapped from slot 0
+            Vector2* body = AllocBody(s->arena, s->capacity);
+            for (int i = 0; i < s->count; i++) body[i] = s->body[(s->head + i) & (oldCapacity - 1)];
+            s->body = body;
+            s->head = 0;
+        } else {
+            s->body = (Vector2*)ENGINE_REALLOC(s->body, s->capacity * sizeof(Vector2));
+
+            // Unwrap: segments that wrapped past the old end move into the new half
+            int wrapped = s->head + s->count - oldCapacity;
+            if (wrapped > 0) memcpy(&s->body[oldCapacity], &s->body[0], wrapped * sizeof(Vector2));
+        }
     }
-    s->body[s->count] = newPart;
+    s->body[(s->head + s->count) & (s->capacity - 1)] = newPart;
     s->count++;
+    if (s->occupancy) OccupancyAdd(s->occupancy, OCC_SNAKE, CellAt(newPart));
 }
 
-void MoveSnake(SnakeData* s) {
-    for (int i = s->count - 1; i > 0; i--) {
-        s->body[i] = s->body[i-1];
+void MoveSnake(SnakeData* s, Vector2 bounds) {
+    Vector2 next = s->body[s->head];
+    next.x += s->direction.x * CELL_SIZE;
+    next.y += s->direction.y * CELL_SIZE;
+
+    // Boundary Clamp (the level's world, which is the screen unless META WORLD says otherwise)
+    if (next.x < 0) next.x = 0;
+    if (next.y < 0) next.y = 0;
+    if (next.x >= bounds.x) next.x = bounds.x - CELL_SIZE;
+    if (next.y >= bounds.y) next.y = bounds.y - CELL_SIZE;
+
+    // Pressed against the edge: stay put rather than folding the body into the head
+    Vector2 head = s->body[s->head];
+    if (next.x == head.x && next.y == head.y) return;
+
+    // The tail leaves its cell before the head enters, so chasing your own tail is legal
+    if (s->occupancy) {
+        OccupancyRemove(s->occupancy, OCC_SNAKE, CellAt(SnakeTail(s)));
+        OccupancyAdd(s->occupancy, OCC_SNAKE, CellAt(next));
     }
-    s->body[0].x += s->direction.x * CELL_SIZE;
-    s->body[0].y += s->direction.y * CELL_SIZE;
 
-    // Boundary Clamp
-    if (s->body[0].x < 0) s->body[0].x = 0;
-    if (s->body[0].y < 0) s->body[0].y = 0;
-    if (s->body[0].x >= SCREEN_W) s->body[0].x = SCREEN_W - CELL_SIZE;
-    if (s->body[0].y >= SCREEN_H) s->body[0].y = SCREEN_H - CELL_SIZE;
+    // New head takes the slot before the old one; when the ring is full that is the old tail
+    s->head = (s->head - 1) & (s->capacity - 1);
+    s->body[s->head] = next;
+}
+
+Vector2 SnakeSegment(const SnakeData* s, int i) {
+    return s->body[(s->head + i) & (s->capacity - 1)];
+}
+
+Vector2 SnakeHead(const SnakeData* s) {
+    return s->body[s->head];
+}
+
+Vector2 SnakeTail(const SnakeData* s) {
+    return SnakeSegment(s, s->count - 1);
+}
+
+// Head lands on another of its own segments. Needs the occupancy grid, which
+// every snake shares: a count of 1 under the head rules a bite out, but more
+// may be another snake, so the snake's own segments decide. They all move in
+// whole cells from the spawn, so a bite is an exact match.
+// A one-segment snake that just ate has its new tail stacked on the head
+// until the next move; that isn't a bite.
+bool SnakeBitesSelf(const SnakeData* s) {
+    if (!s->occupancy || s->count < 2) return false;
+    Vector2 head = SnakeHead(s);
+    Vector2 neck = SnakeSegment(s, 1);
+    if (head.x == neck.x && head.y == neck.y) return false;
+    int cell = CellAt(head);
+    if (cell >= 0 && s->occupancy->counts[OCC_SNAKE][cell] <= 1) return false;
+
+    SnakeIterator it = SnakeBegin(s);
+    it.index = 2;
+    for (Vector2 seg; SnakeNext(&it, &seg); ) {
+        if (seg.x == head.x && seg.y == head.y) return true;
+    }
+    return false;
+}
+
+SnakeIterator SnakeBegin(const SnakeData* s) {
+    return (SnakeIterator){ s, 0 };
+}
+
+bool SnakeNext(SnakeIterator* it, Vector2* segment) {
+    if (it->index >= it->snake->count) return false;
+    *segment = SnakeSegment(it->snake, it->index++);
+    return true;
+}
+
+// The whole body, head first, into out[0 .. count). The ring is at most two
+// runs: from the head to the end of the array, then from slot 0.
+int CopySnakeSegments(const SnakeData* s, Vector2* out) {
+    int first = s->capacity - s->head;
+    if (first > s->count) first = s->count;
+    memcpy(out, &s->body[s->head], (size_t)first * sizeof(Vector2));
+    memcpy(out + first, s->body, (size_t)(s->count - first) * sizeof(Vector2));
+    return s->count;
 }
 
 // --- ENTITY SYSTEM ---
-Entity* SpawnEntity(GameState* state, EntityType type, Vector2 pos, Vector2 size) {
-    if (state->entityCount >= MAX_ENTITIES) return NULL;
+static EntityHandle SpawnSlot(GameState* state, EntityType type, Vector2 pos, Vector2 size, bool trackOccupancy) {
+    int id;
+    if (state->freeCount > 0) id = state->freeList[--state->freeCount];
+    else if (state->entityCount < MAX_ENTITIES) id = state->entityCount++;
+    else return NULL_HANDLE;
     
-    Entity* e = &state->entities[state->entityCount++];
-    e->id = state->entityCount;
-    e->active = true;
-    e->type = type;
-    e->position = pos;
-    e->size = size;
-    e->data = NULL;
-    return e;
-}
-
-void PushEvent(GameState* state, EventType type, Entity* a, Entity* b) {
-    if (state->pendingEvents >= MAX_EVENTS) return;
-    
-    struct Event* e = &state->eventQueue[state->eventTail];
-    e->type = type;
-    e->sender = a;
-    e->receiver = b;
-    
-    state->eventTail = (state->eventTail + 1) % MAX_EVENTS;
-    state->pendingEvents++;
+    state->positions[id] = pos;
+    state->sizes[id] = size;
+    state->types[id] = type;
+    state->active[id] = true;
+    state->component[id] = -1;
+    state->properties[id] = (EntityProperties){0};
+
+    int layer = OccupancyLayerOf(type);
+    if (layer >= 0 && trackOccupancy) OccupancyUpdateRect(&state->occupancy, (OccupancyLayer)layer, pos, size, true);
+    if (type == ENTITY_WALL) state->wallRevision++;
+    state->layoutRevision++;
+
+    state->aliveSlot[id] = state->aliveCount;
+    state->alive[state->aliveCount++] = id;
+    return (EntityHandle){ id, state->generations[id] };
+}
+
+EntityHandle SpawnEntity(GameState* state, EntityType type, Vector2 pos, Vector2 size) {
+    return SpawnSlot(state, type, pos, size, true);
+}
+
+bool IsAlive(const GameState* state, EntityHandle h) {
+    return h.index >= 0 && h.index < state->entityCount &&
+           state->active[h.index] && state->generations[h.index] == h.generation;
+}
+
+EntityHandle HandleOf(const GameState* state, int id) {
+    return (EntityHandle){ id, state->generations[id] };
+}
+
+SnakeData* GetSnake(GameState* state, int id) {
+    if (state->types[id] != ENTITY_SNAKE || state->component[id] < 0) return NULL;
+    return &state->snakes[state->component[id]];
+}
+
+AppleData* GetApple(GameState* state, int id) {
+    if ((state->types[id] != ENTITY_APPLE && state->types[id] != ENTITY_COIN) || state->component[id] < 0) return NULL;
+    return &state->apples[state->component[id]];
+}
+
+EnemyData* GetEnemy(GameState* state, int id) {
+    if (state->types[id] != ENTITY_ENEMY_BASIC || state->component[id] < 0) return NULL;
+    return &state->enemies[state->component[id]];
+}
+
+// Pools stay dense: attaching appends, detaching moves the last element into the hole
+static SnakeData* AttachSnake(GameState* state, int id) {
+    if (state->snakeCount >= MAX_SNAKES) return NULL;
+    state->component[id] = state->snakeCount;
+    state->snakeOwner[state->snakeCount] = id;
+    return &state->snakes[state->snakeCount++];
+}
+
+static AppleData* AttachApple(GameState* state, int id) {
+    state->component[id] = state->appleCount;
+    state->appleOwner[state->appleCount] = id;
+    return &state->apples[state->appleCount++];
+}
+
+static EnemyData* AttachEnemy(GameState* state, int id) {
+    state->component[id] = state->enemyCount;
+    state->enemyOwner[state->enemyCount] = id;
+    return &state->enemies[state->enemyCount++];
+}
+
+static void DetachComponent(GameState* state, int id) {
+    int c = state->component[id];
+    if (c < 0) return;
+    state->component[id] = -1;
+
+    switch (state->types[id]) {
+        case ENTITY_SNAKE: {
+            SnakeData* sData = &state->snakes[c];
+            if (sData->occupancy) {
+                Vector2 seg;
+                for (SnakeIterator it = SnakeBegin(sData); SnakeNext(&it, &seg); ) OccupancyRemove(sData->occupancy, OCC_SNAKE, CellAt(seg));
+            }
+            if (!sData->arena) ENGINE_FREE(sData->body);
+            int last = --state->snakeCount;
+            state->snakes[c] = state->snakes[last];
+            state->snakeOwner[c] = state->snakeOwner[last];
+            if (c != last) state->component[state->snakeOwner[c]] = c;
+        } break;
+        case ENTITY_APPLE:
+        case ENTITY_COIN: {
+            int last = --state->appleCount;
+            state->apples[c] = state->apples[last];
+            state->appleOwner[c] = state->appleOwner[last];
+            if (c != last) state->component[state->appleOwner[c]] = c;
+        } break;
+        case ENTITY_ENEMY_BASIC: {
+            int last = --state->enemyCount;
+            state->enemies[c] = state->enemies[last];
+            state->enemyOwner[c] = state->enemyOwner[last];
+            if (c != last) state->component[state->enemyOwner[c]] = c;
+        } break;
+        default: break;
+    }
+}
+
+void DestroyEntity(GameState* state, EntityHandle h) {
+    if (!IsAlive(state, h)) return;
+    int id = h.index;
+
+    DetachComponent(state, id);
+    int layer = OccupancyLayerOf(state->types[id]);
+    if (layer >= 0) OccupancyUpdateRect(&state->occupancy, (OccupancyLayer)layer, state->positions[id], state->sizes[id], false);
+    if (state->types[id] == ENTITY_WALL) state->wallRevision++;
+    state->layoutRevision++;
+    state->active[id] = false;
+    state->generations[id]++;
+    state->freeList[state->freeCount++] = id;
+
+    // Swap-remove from the dense alive list
+    int slot = state->aliveSlot[id];
+    int last = state->alive[--state->aliveCount];
+    state->alive[slot] = last;
+    state->aliveSlot[last] = slot;
+}
+
+// --- EVENTS ---
+static void ReserveEvents(EventQueue* q, int needed) {
+    if (needed <= q->capacity) return;
+    int capacity = q->capacity ? q->capacity : EVENT_QUEUE_RESERVE;
+    while (capacity < needed) capacity *= 2;
+    q->items = (Event*)ENGINE_REALLOC(q->items, capacity * sizeof(Event));
+    q->capacity = capacity;
+}
+
+void QueueEvent(EventQueue* q, Event e) {
+    ReserveEvents(q, q->count + 1);
+    q->items[q->count++] = e;
+    if (q->count > q->highWater) q->highWater = q->count;
+}
+
+void ClearEventQueue(EventQueue* q) {
+    q->count = 0;
+}
+
+// Appends src[0], src[1], ... in index order and empties them. Each source is
+// owned by one worker, so the merged order only depends on the partition.
+void MergeEventQueues(EventQueue* dst, EventQueue* const* src, int n) {
+    int total = dst->count;
+    for (int i = 0; i < n; i++) total += src[i]->count;
+    ReserveEvents(dst, total);
+    for (int i = 0; i < n; i++) {
+        memcpy(&dst->items[dst->count], src[i]->items, (size_t)src[i]->count * sizeof(Event));
+        dst->count += src[i]->count;
+        src[i]->count = 0;
+    }
+    if (dst->count > dst->highWater) dst->highWater = dst->count;
+}
+
+void FreeEventQueue(EventQueue* q) {
+    ENGINE_FREE(q->items);
+    *q = (EventQueue){0};
+}
+
+void PushEvent(GameState* state, Event e) {
+    QueueEvent(&state->events, e);
 }
 
 // --- PHYSICS ---
+// Indexed by EntityType. Walls, apples and coins only care about the player,
+// so static-vs-static and pickup-vs-wall pairs are rejected before any math.
+static const unsigned int CollisionLayers[] = {
+    [ENTITY_NONE]        = LAYER_NONE,
+    [ENTITY_SNAKE]       = LAYER_PLAYER,
+    [ENTITY_APPLE]       = LAYER_PICKUP,
+    [ENTITY_WALL]        = LAYER_STATIC,
+    [ENTITY_ENEMY_BASIC] = LAYER_HAZARD,
+    [ENTITY_COIN]        = LAYER_PICKUP,
+};
+
+static const unsigned int CollisionMasks[] = {
+    [ENTITY_NONE]        = LAYER_NONE,
+    [ENTITY_SNAKE]       = LAYER_PICKUP | LAYER_STATIC | LAYER_HAZARD,
+    [ENTITY_APPLE]       = LAYER_PLAYER,
+    [ENTITY_WALL]        = LAYER_PLAYER,
+    [ENTITY_ENEMY_BASIC] = LAYER_PLAYER,
+    [ENTITY_COIN]        = LAYER_PLAYER,
+};
+
+bool LayersInteract(EntityType a, EntityType b) {
+    return (CollisionMasks[a] & CollisionLayers[b]) != 0;
+}
+
+static bool EntitiesOverlap(const GameState* state, int a, int b) {
+    Vector2 p1 = state->positions[a], s1 = state->sizes[a];
+    Vector2 p2 = state->positions[b], s2 = state->sizes[b];
+    return (p1.x < p2.x + s2.x &&
+            p1.x + s1.x > p2.x &&
+            p1.y < p2.y + s2.y &&
+            p1.y + s1.y > p2.y);
+}
+
+// Reference path: tests every live pair. Kept for comparing against the grid.
+static void ResolveCollisionsBruteForce(GameState* state) {
+    for (int p = 0; p < state->aliveCount; p++) {
+        int i = state->alive[p];
+        if (CollisionMasks[state->types[i]] == LAYER_NONE) continue;
+
+        for (int q = p + 1; q < state->aliveCount; q++) {
+            int j = state->alive[q];
+            if (!LayersInteract(state->types[i], state->types[j])) continue;
+
+            if (EntitiesOverlap(state, i, j)) PushEvent(state, (Event){ .type = EVENT_COLLISION, .collision = { HandleOf(state, i), HandleOf(state, j) } });
+        }
+    }
+}
+
+static int ClampCell(int c, int max) {
+    if (c < 0) return 0;
+    if (c >= max) return max - 1;
+    return c;
+}
+
+// Inclusive bucket range covered by [pos, pos + size). Anything outside the
+// fitted grid is clamped into the border buckets, which keeps the test conservative.
+static void CellRange(const Broadphase* bp, Vector2 pos, Vector2 size, int* r) {
+    r[0] = ClampCell((int)floorf((pos.x - bp->origin.x) / bp->cellSize.x), GRID_COLS);
+    r[1] = ClampCell((int)floorf((pos.y - bp->origin.y) / bp->cellSize.y), GRID_ROWS);
+    r[2] = ClampCell((int)ceilf((pos.x + size.x - bp->origin.x) / bp->cellSize.x) - 1, GRID_COLS);
+    r[3] = ClampCell((int)ceilf((pos.y + size.y - bp->origin.y) / bp->cellSize.y) - 1, GRID_ROWS);
+    if (r[2] < r[0]) r[2] = r[0];
+    if (r[3] < r[1]) r[3] = r[1];
+}
+
+// Spreads the GRID_COLS x GRID_ROWS buckets over the colliders' bounding box.
+// Buckets never shrink below a cell, so a screen-sized level keeps one bucket
+// per cell, while a streamed world far from the origin doesn't pile up in the
+// border buckets.
+static void FitBroadphase(GameState* state) {
+    Broadphase* bp = &state->broadphase;
+    float minX = 0, minY = 0, maxX = 0, maxY = 0;
+    bool any = false;
+    for (int k = 0; k < state->aliveCount; k++) {
+        int i = state->alive[k];
+        if (CollisionMasks[state->types[i]] == LAYER_NONE) continue;
+        Vector2 p = state->positions[i], e = state->sizes[i];
+        if (!any || p.x < minX) minX = p.x;
+        if (!any || p.y < minY) minY = p.y;
+        if (!any || p.x + e.x > maxX) maxX = p.x + e.x;
+        if (!any || p.y + e.y > maxY) maxY = p.y + e.y;
+        any = true;
+    }
+    float w = (maxX - minX) / GRID_COLS;
+    float h = (maxY - minY) / GRID_ROWS;
+    bp->origin = (Vector2){ minX, minY };
+    bp->cellSize = (Vector2){ w > CELL_SIZE ? w : CELL_SIZE, h > CELL_SIZE ? h : CELL_SIZE };
+}
+
+static int ComparePairs(const void* a, const void* b) {
+    const int* p = (const int*)a;
+    const int* q = (const int*)b;
+    if (p[0] != q[0]) return p[0] - q[0];
+    return p[1] - q[1];
+}
+
+static void ResolveCollisionsGrid(GameState* state) {
+    Broadphase* bp = &state->broadphase;
+    FitBroadphase(state);
+    if (state->aliveCount * 4 > bp->rangeCapacity) {
+        bp->rangeCapacity = state->aliveCount * 8;
+        bp->ranges = (int*)ENGINE_REALLOC(bp->ranges, bp->rangeCapacity * sizeof(int));
+    }
+
+    // 1. Bucket range per collider (kept for the narrowphase), and cell
+    //    references per bucket
+    memset(bp->cellStart, 0, sizeof(bp->cellStart));
+    int total = 0;
+    for (int k = 0; k < state->aliveCount; k++) {
+        int i = state->alive[k];
+        if (CollisionMasks[state->types[i]] == LAYER_NONE) continue;
+        int* r = &bp->ranges[k * 4];
+        CellRange(bp, state->positions[i], state->sizes[i], r);
+        for (int cy = r[1]; cy <= r[3]; cy++)
+            for (int cx = r[0]; cx <= r[2]; cx++) bp->cellStart[cy * GRID_COLS + cx + 1]++;
+        total += (r[2] - r[0] + 1) * (r[3] - r[1] + 1);
+    }
+    if (total > bp->itemCapacity) {
+        bp->itemCapacity = total * 2;
+        bp->items = (int*)ENGINE_REALLOC(bp->items, bp->itemCapacity * sizeof(int));
+    }
+
+    // 2. Prefix sum, then scatter. Buckets hold positions in alive[] and are
+    //    filled in that order, so each bucket stays sorted.
+    for (int c = 0; c < TOTAL_CELLS; c++) bp->cellStart[c + 1] += bp->cellStart[c];
+    int fill[TOTAL_CELLS];
+    memcpy(fill, bp->cellStart, sizeof(fill));
+    for (int k = 0; k < state->aliveCount; k++) {
+        int i = state->alive[k];
+        if (CollisionMasks[state->types[i]] == LAYER_NONE) continue;
+        const int* r = &bp->ranges[k * 4];
+        for (int cy = r[1]; cy <= r[3]; cy++)
+            for (int cx = r[0]; cx <= r[2]; cx++) bp->items[fill[cy * GRID_COLS + cx]++] = k;
+    }
+
+    // 3. Narrowphase within each bucket. A pair sharing several cells is only
+    //    tested in the first cell they share (max of both minimum corners).
+    int pairCount = 0;
+    for (int c = 0; c < TOTAL_CELLS; c++) {
+        int cx = c % GRID_COLS;
+        int cy = c / GRID_COLS;
+        for (int p = bp->cellStart[c]; p < bp->cellStart[c + 1]; p++) {
+            int pa = bp->items[p];
+            int a = state->alive[pa];
+            const int* ra = &bp->ranges[pa * 4];
+
+            for (int q = p + 1; q < bp->cellStart[c + 1]; q++) {
+                int pb = bp->items[q];
+                int b = state->alive[pb];
+                if (!LayersInteract(state->types[a], state->types[b])) continue;
+                const int* rb = &bp->ranges[pb * 4];
+                if ((ra[0] > rb[0] ? ra[0] : rb[0]) != cx || (ra[1] > rb[1] ? ra[1] : rb[1]) != cy) continue;
+                if (!EntitiesOverlap(state, a, b)) continue;
+
+                if (pairCount * 2 + 2 > bp->pairCapacity) {
+                    bp->pairCapacity = bp->pairCapacity ? bp->pairCapacity * 2 : 64;
+                    bp->pairs = (int*)ENGINE_REALLOC(bp->pairs, bp->pairCapacity * sizeof(int));
+                }
+                bp->pairs[pairCount * 2] = pa;
+                bp->pairs[pairCount * 2 + 1] = pb;
+                pairCount++;
+            }
+        }
+    }
+
+    // 4. Emit in alive-list order so the event stream matches the brute-force path
+    if (pairCount > 1) qsort(bp->pairs, pairCount, 2 * sizeof(int), ComparePairs);
+    for (int k = 0; k < pairCount; k++) {
+        int a = state->alive[bp->pairs[k * 2]];
+        int b = state->alive[bp->pairs[k * 2 + 1]];
+        PushEvent(state, (Event){ .type = EVENT_COLLISION, .collision = { HandleOf(state, a), HandleOf(state, b) } });
+    }
+}
+
 void ResolveCollisions(GameState* state) {
-    // Basic N^2 check is fine for < 100 entities
-    for (int i = 0; i < state->entityCount; i++) {
-        Entity* e1 = &state->entities[i];
-        if (!e1->active) continue;
-
-        for (int j = i + 1; j < state->entityCount; j++) {
-            Entity* e2 = &state->entities[j];
-            if (!e2->active) continue;
-
-            // AABB
-            bool hit = (e1->position.x < e2->position.x + e2->size.x &&
-                        e1->position.x + e1->size.x > e2->position.x &&
-                        e1->position.y < e2->position.y + e2->size.y &&
-                        e1->position.y + e1->size.y > e2->position.y);
-            
-            if (hit) PushEvent(state, EVENT_COLLISION, e1, e2);
+    // Snake heads against the bitboards first. Every pair the layer table lets
+    // through involves a snake, so if no head touches an occupied cell there is
+    // nothing for the grid to find this frame.
+    bool anyContact = false;
+    for (int k = 0; k < state->snakeCount; k++) {
+        int id = state->snakeOwner[k];
+        EntityHandle h = HandleOf(state, id);
+        if (SnakeBitesSelf(&state->snakes[k])) {
+            PushEvent(state, (Event){ .type = EVENT_GAME_OVER, .gameOver = { h, h } });
+        }
+        unsigned int solid = OCC_BIT(OCC_WALL) | OCC_BIT(OCC_FOOD) | OCC_BIT(OCC_ENEMY);
+        if (OccupancyTestRect(&state->occupancy, solid, state->positions[id], state->sizes[id])) anyContact = true;
+    }
+
+    if (state->bruteForceCollisions) ResolveCollisionsBruteForce(state);
+    else if (anyContact) ResolveCollisionsGrid(state);
+}
+
+// --- SPATIAL INDEX ---
+// Inclusive tile range covered by [pos, pos + size), clamped into the table
+static void TileRange(const SpatialIndex* index, Vector2 pos, Vector2 size, int* r) {
+    r[0] = ClampCell((int)floorf((pos.x - index->origin.x) / index->tileSize), index->cols);
+    r[1] = ClampCell((int)floorf((pos.y - index->origin.y) / index->tileSize), index->rows);
+    r[2] = ClampCell((int)ceilf((pos.x + size.x - index->origin.x) / index->tileSize) - 1, index->cols);
+    r[3] = ClampCell((int)ceilf((pos.y + size.y - index->origin.y) / index->tileSize) - 1, index->rows);
+    if (r[2] < r[0]) r[2] = r[0];
+    if (r[3] < r[1]) r[3] = r[1];
+}
+
+static bool ReserveTiles(SpatialIndex* index, int tiles) {
+    if (tiles <= index->tileCapacity) return true;
+    int* start = (int*)ENGINE_REALLOC(index->tileStart, (size_t)(tiles + 1) * sizeof(int));
+    if (!start) return false;
+    index->tileStart = start;
+    int* fill = (int*)ENGINE_REALLOC(index->tileFill, (size_t)tiles * sizeof(int));
+    if (!fill) return false;
+    index->tileFill = fill;
+    index->tileCapacity = tiles;
+    return true;
+}
+
+// Counting sort into tiles over the indexed entities' bounding box, the same
+// way the broadphase fills its buckets
+void UpdateSpatialIndex(SpatialIndex* index, const RenderSnapshot* snap) {
+    if (index->built && index->level == snap->level && index->revision == snap->layoutRevision) return;
+    index->built = true;
+    index->level = snap->level;
+    index->revision = snap->layoutRevision;
+    index->cols = index->rows = 0;
+
+    float minX = 0, minY = 0, maxX = 0, maxY = 0;
+    int indexed = 0;
+    for (int i = 0; i < snap->count; i++) {
+        if (snap->types[i] == ENTITY_SNAKE) continue;
+        Vector2 p = snap->positions[i], e = snap->sizes[i];
+        if (!indexed || p.x < minX) minX = p.x;
+        if (!indexed || p.y < minY) minY = p.y;
+        if (!indexed || p.x + e.x > maxX) maxX = p.x + e.x;
+        if (!indexed || p.y + e.y > maxY) maxY = p.y + e.y;
+        indexed++;
+    }
+    if (indexed == 0) return;
+
+    // Keep the table proportional to the entity count, however sparse the world
+    float tile = SPATIAL_TILE;
+    int cols, rows;
+    for (;;) {
+        cols = (int)((maxX - minX) / tile) + 1;
+        rows = (int)((maxY - minY) / tile) + 1;
+        if ((long long)cols * rows <= 4LL * indexed + 64) break;
+        tile *= 2;
+    }
+    if (!ReserveTiles(index, cols * rows)) return;
+    index->origin = (Vector2){ minX, minY };
+    index->tileSize = tile;
+    index->cols = cols;
+    index->rows = rows;
+
+    int tiles = cols * rows;
+    memset(index->tileStart, 0, (size_t)(tiles + 1) * sizeof(int));
+    int total = 0;
+    for (int i = 0; i < snap->count; i++) {
+        if (snap->types[i] == ENTITY_SNAKE) continue;
+        int r[4];
+        TileRange(index, snap->positions[i], snap->sizes[i], r);
+        for (int ty = r[1]; ty <= r[3]; ty++)
+            for (int tx = r[0]; tx <= r[2]; tx++) index->tileStart[ty * cols + tx + 1]++;
+        total += (r[2] - r[0] + 1) * (r[3] - r[1] + 1);
+    }
+    if (total > index->itemCapacity) {
+        int* items = (int*)ENGINE_REALLOC(index->items, (size_t)total * 2 * sizeof(int));
+        if (!items) { index->cols = index->rows = 0; return; }
+        index->items = items;
+        index->itemCapacity = total * 2;
+    }
+
+    for (int t = 0; t < tiles; t++) index->tileStart[t + 1] += index->tileStart[t];
+    memcpy(index->tileFill, index->tileStart, (size_t)tiles * sizeof(int));
+    for (int i = 0; i < snap->count; i++) {
+        if (snap->types[i] == ENTITY_SNAKE) continue;
+        int r[4];
+        TileRange(index, snap->positions[i], snap->sizes[i], r);
+        for (int ty = r[1]; ty <= r[3]; ty++)
+            for (int tx = r[0]; tx <= r[2]; tx++) index->items[index->tileFill[ty * cols + tx]++] = i;
+    }
+}
+
+// Calls onEntity once for each indexed entity overlapping [pos, pos + size),
+// in tile order. snap may be any snapshot of the same level and layout.
+void QuerySpatialIndex(const SpatialIndex* index, const RenderSnapshot* snap, Vector2 pos, Vector2 size, SpatialQueryFn onEntity, void* user) {
+    if (index->cols == 0) return;
+    int q[4];
+    TileRange(index, pos, size, q);
+    for (int ty = q[1]; ty <= q[3]; ty++) {
+        for (int tx = q[0]; tx <= q[2]; tx++) {
+            int t = ty * index->cols + tx;
+            for (int p = index->tileStart[t]; p < index->tileStart[t + 1]; p++) {
+                int i = index->items[p];
+                Vector2 ep = snap->positions[i], es = snap->sizes[i];
+
+                // An entity in several tiles is reported from the first one it shares with the query
+                int r[4];
+                TileRange(index, ep, es, r);
+                if ((r[0] > q[0] ? r[0] : q[0]) != tx || (r[1] > q[1] ? r[1] : q[1]) != ty) continue;
+                if (ep.x >= pos.x + size.x || pos.x >= ep.x + es.x || ep.y >= pos.y + size.y || pos.y >= ep.y + es.y) continue;
+                onEntity(user, i);
+            }
         }
     }
 }
 
+void FreeSpatialIndex(SpatialIndex* index) {
+    ENGINE_FREE(index->tileStart);
+    ENGINE_FREE(index->tileFill);
+    ENGINE_FREE(index->items);
+    *index = (SpatialIndex){0};
+}
+
 // --- LOGIC ---
+static void HandleCollision(GameState* state, Event e) {
+    EntityHandle snakeHandle = (state->types[e.collision.a.index] == ENTITY_SNAKE) ? e.collision.a : e.collision.b;
+    EntityHandle otherHandle = (state->types[e.collision.a.index] == ENTITY_SNAKE) ? e.collision.b : e.collision.a;
+    int snake = snakeHandle.index;
+    int other = otherHandle.index;
+    EntityType otherType = state->types[other];
+
+    // Snake Logic
+    if (state->types[snake] != ENTITY_SNAKE) return;
+
+    // Eat Apple or Coin
+    if (otherType == ENTITY_APPLE || otherType == ENTITY_COIN) {
+        SnakeData* sData = GetSnake(state, snake);
+        int points = 10;
+        
+        // Retrieve specific data
+        AppleData* aData = GetApple(state, other);
+        if (aData) points = aData->value;
+        
+        // Grow Snake
+        if (sData && sData->count > 0) {
+            AppendSnake(sData, SnakeTail(sData));
+        }
+        
+        DestroyEntity(state, otherHandle);
+        state->score += points;
+    }
+    // Hit Wall or Enemy
+    else if (otherType == ENTITY_WALL || otherType == ENTITY_ENEMY_BASIC) {
+        PushEvent(state, (Event){ .type = EVENT_GAME_OVER, .gameOver = { snakeHandle, otherHandle } });
+    }
+}
+
 void ProcessEvents(GameState* state) {
-    while (state->pendingEvents > 0) {
-        struct Event e = state->eventQueue[state->eventHead];
-        state->eventHead = (state->eventHead + 1) % MAX_EVENTS;
-        state->pendingEvents--;
-
-        if (e.type == EVENT_COLLISION) {
-            Entity* snake = (e.sender->type == ENTITY_SNAKE) ? e.sender : e.receiver;
-            Entity* other = (e.sender->type == ENTITY_SNAKE) ? e.receiver : e.sender;
-
-            // Snake Logic
-            if (snake->type == ENTITY_SNAKE) {
-                
-                // Eat Apple or Coin
-                if (other->type == ENTITY_APPLE || other->type == ENTITY_COIN) {
-                    SnakeData* sData = (SnakeData*)snake->data;
-                    int points = 10;
-                    
-                    // Retrieve specific data
-                    if (other->data) {
-                        AppleData* aData = (AppleData*)other->data;
-                        points = aData->value;
-                    }
-                    
-                    // Grow Snake
-                    if (sData->count > 0) {
-                        Vector2 tailPos = sData->body[sData->count-1];
-                        AppendSnake(sData, tailPos); 
-                    }
-                    
-                    other->active = false; 
-                    state->score += points;
-                }
-                // Hit Wall or Enemy
-                else if (other->type == ENTITY_WALL || other->type == ENTITY_ENEMY_BASIC) {
-                    state->gameOver = true;
-                }
-            }
+    // Handlers may queue follow-up events; they are picked up by this same loop
+    for (int i = 0; i < state->events.count; i++) {
+        Event e = state->events.items[i];
+
+        switch (e.type) {
+            case EVENT_COLLISION:
+                // Either side may have been destroyed by an earlier event this frame
+                if (!IsAlive(state, e.collision.a) || !IsAlive(state, e.collision.b)) break;
+                HandleCollision(state, e);
+                break;
+            case EVENT_GAME_OVER:
+                state->gameOver = true;
+                break;
+            default: break;
         }
     }
+    ClearEventQueue(&state->events);
 }
 
-void CheckLevelProgression(GameState* state) {
-    // If target score reached, you could load next level
-    // For now, we just print
-    if (state->score >= state->levelTargetScore) {
-        DrawText("TARGET REACHED!", 200, 200, 40, GREEN);
+// --- SIMULATION ---
+// One fixed step of SIM_DT. Timers only ever advance by SIM_DT, so the same
+// input sequence gives the same game no matter how steps map onto frames.
+void StepWorld(GameState* state, InputFrame input) {
+    if (state->gameOver) return;
+
+    // 1. Snake Input & Move
+    for (int k = 0; k < state->snakeCount; k++) {
+        int id = state->snakeOwner[k];
+        SnakeData* s = &state->snakes[k];
+        if (input.turn.y != 0 && s->direction.y == 0) s->direction = (Vector2){0, input.turn.y};
+        if (input.turn.x != 0 && s->direction.x == 0) s->direction = (Vector2){input.turn.x, 0};
+
+        // USE LEVEL SPEED (leftover time carries into the next move)
+        s->moveTimer += SIM_DT;
+        if (s->moveTimer >= state->levelBaseSpeed) {
+            MoveSnake(s, state->worldSize);
+            state->positions[id] = SnakeHead(s);
+            s->moveTimer -= state->levelBaseSpeed;
+        }
+    }
+
+    // 2. Enemy Move (Basic)
+    for (int k = 0; k < state->enemyCount; k++) {
+        EnemyData* en = &state->enemies[k];
+        en->moveTimer += SIM_DT;
+        // Simple patrol logic could go here
+        // state->positions[state->enemyOwner[k]].x += en->direction.x * en->speed;
     }
+
+    // 3. Stream chunks in and out around the snake
+    if (state->stream) UpdateChunkStream(state);
+
+    ResolveCollisions(state);
+    ProcessEvents(state);
+    state->tick++;
+}
+
+// True once the level's target score is reached. Drawing the banner is up to the caller.
+bool CheckLevelProgression(const GameState* state) {
+    return state->score - state->levelStartScore >= state->levelTargetScore;
 }
 
 // --- FILE LOADER (The Bridge) ---
-void LoadLevel(GameState* state, const char* filename) {
-    // 1. Cleanup old memory
-    for(int i=0; i<state->entityCount; i++) {
-        if (state->entities[i].data) free(state->entities[i].data);
-    }
+// Retire every slot and restore level defaults. Generations keep counting up,
+// so handles from the previous level (including queued events) can never
+// match a new entity.
+void ResetLevel(GameState* state) {
+    for (int i = 0; i < state->entityCount; i++) state->generations[i]++;
     state->entityCount = 0;
+    state->freeCount = 0;
+    state->aliveCount = 0;
+    ClearEventQueue(&state->events);
+    state->events.highWater = 0;
+    ArenaReset(&state->levelArena);
+    memset(&state->occupancy, 0, sizeof(state->occupancy));
+    state->wallRevision++;
+    state->layoutRevision++;
+    state->snakeCount = 0;
+    state->appleCount = 0;
+    state->enemyCount = 0;
     state->gameOver = false;
-    state->levelTargetScore = 999;
-    state->levelBaseSpeed = 0.15f;
+    state->tick = 0;
+    ApplyLevelMeta(state, DefaultLevelMeta());
+    FreeChunkStream(state);
+}
 
-    FILE* file = fopen(filename, "r");
-    if (!file) { printf("Failed to load %s\n", filename); return; }
+// What a level without META lines gets
+LevelMeta DefaultLevelMeta(void) {
+    return (LevelMeta){ 999, 0.15f, { SCREEN_W, SCREEN_H } };
+}
 
-    char line[256];
-    while (fgets(line, sizeof(line), file)) {
-        if (line[0] == '#' || line[0] == '\n') continue;
+LevelMeta LevelMetaOf(const GameState* state) {
+    return (LevelMeta){ state->levelTargetScore, state->levelBaseSpeed, state->worldSize };
+}
 
-        // A. Parse Metadata
-        if (strncmp(line, "META TARGET", 11) == 0) { sscanf(line, "META TARGET %d", &state->levelTargetScore); continue; }
-        if (strncmp(line, "META SPEED", 10) == 0) { sscanf(line, "META SPEED %f", &state->levelBaseSpeed); continue; }
+void ApplyLevelMeta(GameState* state, LevelMeta meta) {
+    state->levelTargetScore = meta.targetScore;
+    state->levelBaseSpeed = meta.baseSpeed;
+    state->worldSize = meta.worldSize;
+}
 
-        // B. Parse Entity
-        char typeChar;
-        int x, y, w, h, val, sub;
-        float spd;
+// Enemies patrol vertically for subtype 0, horizontally otherwise
+static Vector2 EnemyDirection(int sub) {
+    return (sub == 0) ? (Vector2){0, -1} : (Vector2){1, 0};
+}
 
-        int matches = sscanf(line, "%c %d %d %d %d %d %d %f", &typeChar, &x, &y, &w, &h, &val, &sub, &spd);
-        
-        if (matches > 0) {
-            // Defaults
-            if (matches < 6) val = 10;
-            if (matches < 7) sub = 1;
-            if (matches < 8) spd = 0.0f;
-
-            EntityType type = ENTITY_NONE;
-            if (typeChar == 'P') type = ENTITY_SNAKE;
-            else if (typeChar == 'A') type = ENTITY_APPLE;
-            else if (typeChar == 'W') type = ENTITY_WALL;
-            else if (typeChar == 'E') type = ENTITY_ENEMY_BASIC;
-            else if (typeChar == 'C') type = ENTITY_COIN;
-
-            Entity* e = SpawnEntity(state, type, (Vector2){(float)x, (float)y}, (Vector2){(float)w, (float)h});
-            if (e) {
-                // Store generics just in case
-                e->propertyValue = val;
-                e->propertySubtype = sub;
-                e->propertySpeed = spd;
-
-                // C. Map Generics to Specifics
-                if (type == ENTITY_SNAKE) {
-                    SnakeData* sData = (SnakeData*)malloc(sizeof(SnakeData));
-                    InitSnake(sData, e->position);
-                    // Map Subtype -> Direction
-                    if (sub == 0) sData->direction = (Vector2){0, -1};      // Up
-                    else if (sub == 1) sData->direction = (Vector2){1, 0};  // Right
-                    else if (sub == 2) sData->direction = (Vector2){0, 1};  // Down
-                    else if (sub == 3) sData->direction = (Vector2){-1, 0}; // Left
-                    e->data = sData;
-                }
-                else if (type == ENTITY_APPLE || type == ENTITY_COIN) {
-                    AppleData* aData = (AppleData*)malloc(sizeof(AppleData));
-                    aData->value = val; // Map generic value -> specific points
-                    e->data = aData;
-                }
-                else if (type == ENTITY_ENEMY_BASIC) {
-                    EnemyData* enData = (EnemyData*)malloc(sizeof(EnemyData));
-                    enData->speed = spd;
-                    enData->moveTimer = 0;
-                    if (sub == 0) enData->direction = (Vector2){0, -1};
-                    else enData->direction = (Vector2){1, 0};
-                    e->data = enData;
-                }
-            }
+// Turns one authoring record into a live entity with its component attached.
+// Binary levels that ship a baked wall grid pass trackWalls = false.
+EntityHandle SpawnLevelEntity(GameState* state, const Entity* def, bool trackWalls) {
+    bool track = trackWalls || def->type != ENTITY_WALL;
+    EntityHandle handle = SpawnSlot(state, def->type, def->position, def->size, track);
+    if (handle.index < 0) return handle;
+
+    int id = handle.index;
+    int sub = def->propertySubtype;
+    // Store generics just in case
+    state->properties[id] = (EntityProperties){ def->propertyValue, sub, def->propertySpeed };
+
+    // C. Map Generics to Specifics
+    if (def->type == ENTITY_SNAKE) {
+        SnakeData* sData = AttachSnake(state, id);
+        if (!sData) { DestroyEntity(state, handle); return NULL_HANDLE; }
+        InitSnake(sData, state->positions[id], &state->levelArena, TOTAL_CELLS, &state->occupancy);
+        // Map Subtype -> Direction
+        if (sub == 0) sData->direction = (Vector2){0, -1};      // Up
+        else if (sub == 1) sData->direction = (Vector2){1, 0};  // Right
+        else if (sub == 2) sData->direction = (Vector2){0, 1};  // Down
+        else if (sub == 3) sData->direction = (Vector2){-1, 0}; // Left
+    }
+    else if (def->type == ENTITY_APPLE || def->type == ENTITY_COIN) {
+        AppleData* aData = AttachApple(state, id);
+        aData->value = def->propertyValue; // Map generic value -> specific points
+    }
+    else if (def->type == ENTITY_ENEMY_BASIC) {
+        EnemyData* enData = AttachEnemy(state, id);
+        enData->speed = def->propertySpeed;
+        enData->moveTimer = 0;
+        enData->direction = EnemyDirection(sub);
+    }
+    return handle;
+}
+
+// The authoring record an entity was built from (tools, caches, reloads)
+Entity EntityRecordOf(const GameState* state, int id) {
+    EntityProperties p = state->properties[id];
+    return (Entity){ true, state->types[id], state->positions[id], state->sizes[id], p.value, p.subtype, p.speed };
+}
+
+// Applies an edited authoring record to a live entity in place (hot reload).
+// Snakes keep their body and heading; only their stored properties change.
+void UpdateLevelEntity(GameState* state, EntityHandle handle, const Entity* def) {
+    if (!IsAlive(state, handle) || state->types[handle.index] != def->type) return;
+    int id = handle.index;
+    state->properties[id] = (EntityProperties){ def->propertyValue, def->propertySubtype, def->propertySpeed };
+    if (def->type == ENTITY_SNAKE) return;
+
+    int layer = OccupancyLayerOf(def->type);
+    if (layer >= 0) {
+        OccupancyUpdateRect(&state->occupancy, (OccupancyLayer)layer, state->positions[id], state->sizes[id], false);
+        OccupancyUpdateRect(&state->occupancy, (OccupancyLayer)layer, def->position, def->size, true);
+    }
+    state->positions[id] = def->position;
+    state->sizes[id] = def->size;
+    if (def->type == ENTITY_WALL) state->wallRevision++;
+    state->layoutRevision++;
+
+    AppleData* aData = GetApple(state, id);
+    if (aData) aData->value = def->propertyValue;
+    EnemyData* enData = GetEnemy(state, id);
+    if (enData) {
+        enData->speed = def->propertySpeed;
+        enData->direction = EnemyDirection(def->propertySubtype);
+    }
+}
+
+bool HasExtension(const char* filename, const char* ext) {
+    size_t n = strlen(filename), e = strlen(ext);
+    return n >= e && strcmp(filename + n - e, ext) == 0;
+}
+
+// .engb files take the binary path, .engc files stream in chunks and
+// "pack.engp:name" opens a level inside a pack; anything else is parsed as
+// .eng text
+bool LoadLevel(GameState* state, const char* filename) {
+    ResetLevel(state);
+    bool ok = IsPackedLevelPath(filename) ? LoadLevelFromPack(state, filename)
+            : HasExtension(filename, ".engb") ? LoadLevelBinary(state, filename)
+            : HasExtension(filename, ".engc") ? LoadLevelChunked(state, filename)
+            : LoadLevelText(state, filename);
+    if (ok) EngineLog("Level Loaded. Target: %d, Speed: %.2f", state->levelTargetScore, state->levelBaseSpeed);
+    return ok;
+}
+
+// Every authoring record of a level in file order, whatever the format, for
+// tools that need the whole level rather than a live world. Text and chunked
+// levels are read record by record (no MAX_ENTITIES limit); .engb and packed
+// levels go through the loader into scratch.
+bool ReadLevelRecords(const char* path, GameState* scratch, LevelMeta* meta, LevelEntityFn onEntity, void* user) {
+    ResetLevel(scratch);
+    *meta = DefaultLevelMeta();
+    if (HasExtension(path, ".engc")) return ReadLevelChunked(path, meta, onEntity, user);
+    if (HasExtension(path, ".engb") || IsPackedLevelPath(path)) {
+        if (!LoadLevel(scratch, path)) return false;
+        *meta = LevelMetaOf(scratch);
+        for (int k = 0; k < scratch->aliveCount; k++) {
+            Entity e = EntityRecordOf(scratch, scratch->alive[k]);
+            onEntity(user, &e);
         }
+        return true;
+    }
+
+    LevelError error = {0};
+    if (!ParseLevelFile(path, meta, onEntity, user, &error)) { PrintLevelError(path, error); return false; }
+    return true;
+}
+
+// Releases the heap memory a GameState owns (arena, broadphase and event
+// buffers). The struct itself belongs to the caller.
+void UnloadGameState(GameState* state) {
+    for (int k = 0; k < state->snakeCount; k++) {
+        if (!state->snakes[k].arena) ENGINE_FREE(state->snakes[k].body);
     }
-    fclose(file);
-    printf("Level Loaded. Target: %d, Speed: %.2f\n", state->levelTargetScore, state->levelBaseSpeed);
+    state->snakeCount = 0;
+    FreeChunkStream(state);
+    ArenaFree(&state->levelArena);
+    ENGINE_FREE(state->broadphase.items);
+    ENGINE_FREE(state->broadphase.pairs);
+    ENGINE_FREE(state->broadphase.ranges);
+    state->broadphase = (Broadphase){0};
+    FreeEventQueue(&state->events);
 }
\ No newline at end of file
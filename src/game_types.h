@@ -1,10 +1,24 @@
 #ifndef GAME_TYPES_H
 #define GAME_TYPES_H
 
-#include "raylib.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+// --- MATH TYPES ---
+// The engine only needs raylib's Vector2. Declaring it here (behind raylib's
+// own guard) lets the simulation build without raylib; when raylib.h is also
+// included, whichever comes first defines the identical struct.
+#if !defined(RL_VECTOR2_TYPE)
+typedef struct Vector2 {
+    float x;
+    float y;
+} Vector2;
+#define RL_VECTOR2_TYPE
+#endif
 
 // --- CONSTANTS ---
 #define SCREEN_W 800
@@ -13,9 +27,25 @@
 #define GRID_COLS (SCREEN_W / CELL_SIZE)
 #define GRID_ROWS (SCREEN_H / CELL_SIZE)
 #define TOTAL_CELLS (GRID_COLS * GRID_ROWS)
+#define SIM_TICK_RATE 60                  // Simulation steps per second, independent of FPS
+#define SIM_DT (1.0f / SIM_TICK_RATE)
+#define MAX_STEPS_PER_FRAME 8             // Catch-up limit after a long frame
+#define GRID_WORDS ((TOTAL_CELLS + 63) / 64) // 3 words for the default 16x12 grid
+#define LEVEL_ARENA_RESERVE (64 * 1024)
+
+#ifndef MAX_ENTITIES
+#define MAX_ENTITIES 1000   // Can be raised per build (the bench uses 100k)
+#endif
+#define EVENT_QUEUE_RESERVE 128 // Initial capacity; queues grow on demand
+#define MAX_SNAKES 4
 
-#define MAX_ENTITIES 1000
-#define MAX_EVENTS 100
+// Allocation hooks. A translation unit that compiles the engine itself (e.g.
+// the bench) can define these first to count or redirect allocations.
+#ifndef ENGINE_MALLOC
+#define ENGINE_MALLOC(size) malloc(size)
+#define ENGINE_REALLOC(ptr, size) realloc(ptr, size)
+#define ENGINE_FREE(ptr) free(ptr)
+#endif
 
 // --- ENUMS ---
 typedef enum EntityType {
@@ -27,21 +57,109 @@ typedef enum EntityType {
     ENTITY_COIN         // New: Different score item
 } EntityType;
 
+// Each entity type sits on one layer and lists the layers it reacts to.
+// Pairs whose layers don't match each other's mask are never AABB-tested.
+typedef enum CollisionLayer {
+    LAYER_NONE   = 0,
+    LAYER_PLAYER = 1 << 0,
+    LAYER_PICKUP = 1 << 1,
+    LAYER_STATIC = 1 << 2,
+    LAYER_HAZARD = 1 << 3
+} CollisionLayer;
+
 typedef enum EventType {
     EVENT_NONE,
     EVENT_COLLISION,
     EVENT_GAME_OVER
 } EventType;
 
+// --- MEMORY ---
+// Bump allocator for per-level data. Everything allocated while a level is
+// live is released by a single ArenaReset on the next load.
+typedef struct ArenaBlock {
+    struct ArenaBlock* next;
+    size_t size;
+    size_t used;
+    unsigned char data[];
+} ArenaBlock;
+
+typedef struct Arena {
+    ArenaBlock* blocks;     // Newest first
+    size_t reserve;         // Minimum block size
+    size_t peak;            // Largest total ever live, used to size the block after a reset
+} Arena;
+
+// --- HANDLES ---
+// Slot index plus the generation the slot had when the handle was issued.
+// Destroying an entity bumps its slot's generation, so old handles go stale
+// instead of silently pointing at whatever reuses the slot.
+typedef struct EntityHandle {
+    int index;
+    unsigned int generation;
+} EntityHandle;
+
+#define NULL_HANDLE ((EntityHandle){ -1, 0 })
+
+// --- OCCUPANCY ---
+// One bit per grid cell per layer, packed into 64-bit words. The default grid
+// is three words per layer; larger GRID_COLS/GRID_ROWS just add words, the
+// API stays the same. counts[] tracks how many things cover a cell so
+// overlapping walls or stacked snake segments can be removed independently.
+// A count that reaches OCC_COUNT_MAX sticks there: the cell stays occupied
+// rather than wrapping to empty under a raised MAX_ENTITIES.
+typedef enum OccupancyLayer {
+    OCC_WALL = 0,
+    OCC_FOOD,
+    OCC_ENEMY,
+    OCC_SNAKE,
+    OCC_LAYER_COUNT
+} OccupancyLayer;
+
+#define OCC_BIT(layer) (1u << (layer))
+#define OCC_COUNT_MAX UINT16_MAX    // Counts are uint16_t, as baked into .engb
+
+typedef struct OccupancyGrid {
+    uint64_t bits[OCC_LAYER_COUNT][GRID_WORDS];
+    uint16_t counts[OCC_LAYER_COUNT][TOTAL_CELLS];
+} OccupancyGrid;
+
+// --- EVENTS ---
+// Payload is picked by type. Events only carry handles, never raw pointers.
+typedef struct Event {
+    EventType type;
+    union {
+        struct { EntityHandle a, b; } collision;
+        struct { EntityHandle snake, cause; } gameOver;
+    };
+} Event;
+
+// Flat growable array, drained front to back each frame. Worker threads each
+// fill their own queue and MergeEventQueues appends them in a fixed order.
+typedef struct EventQueue {
+    Event* items;
+    int count;
+    int capacity;
+    int highWater;  // Largest count seen since the level was loaded
+} EventQueue;
+
 // --- SPECIFIC RUNTIME DATA (The "Game" side) ---
 typedef struct SnakeData {
-    Vector2* body;
+    Vector2* body;      // Ring buffer: body[head] is the head, segments follow in slot order
+    Arena* arena;       // Where body lives; NULL means the heap
+    OccupancyGrid* occupancy; // Kept in sync with the body's cells; may be NULL
+    int head;
     int count;
-    int capacity;
+    int capacity;       // Always a power of two so indices wrap with a mask
     Vector2 direction;
     float moveTimer;
 } SnakeData;
 
+// Walks the body from head to tail without exposing the ring layout
+typedef struct SnakeIterator {
+    const SnakeData* snake;
+    int index;
+} SnakeIterator;
+
 typedef struct AppleData {
     int value; // Points worth
 } AppleData;
@@ -53,8 +171,9 @@ typedef struct EnemyData {
 } EnemyData;
 
 // --- GENERIC ENTITY (The "Editor" side) ---
+// Authoring record: what a level file line describes. The editor keeps arrays
+// of these; the engine unpacks them into the component arrays below on load.
 typedef struct Entity {
-    int id;
     bool active;
     EntityType type;
     Vector2 position;
@@ -65,46 +184,508 @@ typedef struct Entity {
     int propertyValue;      // Used for: Score, Damage, ID
     int propertySubtype;    // Used for: Direction (0=Up, 1=Right...), State
     float propertySpeed;    // Used for: Movement Speed
-    
-    // RUNTIME DATA (Pointer to specific structs above)
-    void* data; 
 } Entity;
 
+// Cold copy of the authoring properties, kept per entity for tools and saving
+typedef struct EntityProperties {
+    int value;
+    int subtype;
+    float speed;
+} EntityProperties;
+
+// --- LEVEL TEXT (.eng) ---
+// Level-wide settings from the META lines
+typedef struct LevelMeta {
+    int targetScore;
+    float baseSpeed;
+    Vector2 worldSize;      // META WORLD; the screen unless a level asks for more
+} LevelMeta;
+
+// Where and why a text level failed to parse (1-based line and column)
+typedef struct LevelError {
+    int line;
+    int column;
+    const char* message;
+} LevelError;
+
+// Called once per entity line, in file order
+typedef void (*LevelEntityFn)(void* user, const Entity* def);
+
+// --- INPUT ---
+// Everything the simulation needs from the player for one tick. turn is a
+// unit direction, or {0, 0} for "keep going".
+typedef struct InputFrame {
+    Vector2 turn;
+} InputFrame;
+
+// --- BROADPHASE ---
+// Uniform grid over the playfield, one bucket per cell. Rebuilt every frame
+// with a counting sort; large entities are inserted into every cell they cover.
+typedef struct Broadphase {
+    int cellStart[TOTAL_CELLS + 1]; // Bucket c is items[cellStart[c] .. cellStart[c+1])
+    int* items;                     // Positions in alive[], grouped by cell
+    int itemCapacity;
+    int* ranges;                    // Per alive[] position: x0, y0, x1, y1 bucket range
+    int rangeCapacity;
+    Vector2 origin;                 // The grid is refitted to the colliders every frame,
+    Vector2 cellSize;               // so worlds larger than the screen still spread out
+    int* pairs;                     // Overlapping (a, b) alive[] position pairs found this frame
+    int pairCapacity;
+} Broadphase;
+
+// --- CHUNK STREAMING ---
+// A chunked level (.engc) keeps only the chunks around the first snake
+// resident. Memory is bounded by the resident window, not the level size.
+#define STREAM_RADIUS 1         // Chunks kept on each side of the snake's chunk
+#define MAX_RESIDENT_CHUNKS ((2 * STREAM_RADIUS + 1) * (2 * STREAM_RADIUS + 1))
+
+typedef struct ResidentChunk {
+    int index;              // Chunk index, -1 for a free slot
+    int count;
+    EntityHandle* handles;  // The entity each of the chunk's records spawned
+} ResidentChunk;
+
+typedef struct ChunkStream {
+    void* map;              // The mmapped .engc file
+    size_t mapSize;
+    const void* chunkTable;
+    const void* records;
+    int chunkCells;         // Chunk edge, in cells
+    int chunksX, chunksY;
+    int maxChunkRecords;
+    int focusX, focusY;     // Chunk the window is centred on, -1 before the first update
+    ResidentChunk resident[MAX_RESIDENT_CHUNKS];
+    EntityHandle* handleStorage; // MAX_RESIDENT_CHUNKS * maxChunkRecords
+    uint8_t* consumed;      // One bit per record destroyed in play (eaten pickups stay eaten)
+} ChunkStream;
+
 // --- THE WORLD STATE ---
+// Entities are stored as parallel arrays indexed by entity id, so the update,
+// collision and draw loops stream only the fields they touch. Type-specific
+// state lives in dense per-component pools; component[id] indexes into the
+// pool that matches types[id], or is -1 when the type has no runtime data.
+// Freed slots go on a free list, and alive[] lists the live ids densely so
+// loops never visit dead slots.
 typedef struct GameState {
-    Entity entities[MAX_ENTITIES];
-    int entityCount;
+    // HOT ENTITY DATA
+    Vector2 positions[MAX_ENTITIES];
+    Vector2 sizes[MAX_ENTITIES];
+    EntityType types[MAX_ENTITIES];
+    bool active[MAX_ENTITIES];
+    int component[MAX_ENTITIES];
+    int entityCount;                // Slots ever handed out (high-water mark)
+
+    // SLOT ALLOCATION
+    unsigned int generations[MAX_ENTITIES];
+    int freeList[MAX_ENTITIES];
+    int freeCount;
+    int alive[MAX_ENTITIES];        // Live ids, in spawn order until something dies
+    int aliveSlot[MAX_ENTITIES];    // Position of each live id inside alive[]
+    int aliveCount;
+
+    // COLD ENTITY DATA
+    EntityProperties properties[MAX_ENTITIES];
+
+    // COMPONENT POOLS
+    SnakeData snakes[MAX_SNAKES];
+    int snakeOwner[MAX_SNAKES];
+    int snakeCount;
+    AppleData apples[MAX_ENTITIES];
+    int appleOwner[MAX_ENTITIES];
+    int appleCount;
+    EnemyData enemies[MAX_ENTITIES];
+    int enemyOwner[MAX_ENTITIES];
+    int enemyCount;
     
+    // Per-level allocations (snake bodies), reset by LoadLevel
+    Arena levelArena;
+
     // LEVEL SETTINGS (Meta)
     int levelTargetScore;
     float levelBaseSpeed;
+    Vector2 worldSize;      // Snakes are clamped to [0, worldSize)
+    ChunkStream* stream;    // Set while a chunked level is streaming, else NULL
     
     // RUNTIME STATE
     int score;
+    int levelStartScore;    // Score carried in from earlier levels; targets count from here
     bool gameOver;
     int currentLevel;
+    unsigned int tick;      // Fixed steps simulated since the level loaded
     
+    // PHYSICS
+    OccupancyGrid occupancy;
+    unsigned int wallRevision; // Bumped when a wall is added, moved or removed, or the level resets
+    unsigned int layoutRevision; // Same, for any entity; steps moving snakes don't count
+    Broadphase broadphase;
+    bool bruteForceCollisions; // Debug: use the reference N^2 pair loop instead of the grid
+
     // EVENTS
-    struct Event {
-        EventType type;
-        Entity* sender;
-        Entity* receiver;
-    } eventQueue[MAX_EVENTS];
-    int eventHead;
-    int eventTail;
-    int pendingEvents;
+    EventQueue events;
 } GameState;
 
+// --- RENDER SNAPSHOTS ---
+// What drawing needs from one tick, copied out of the GameState so the
+// renderer never reads memory the simulation is writing. Entities are dense,
+// in alive order; snake bodies are unwrapped head first into segments.
+typedef struct SnapshotSnake {
+    int first;                  // The head's index in segments
+    int count;
+    Vector2 size;
+} SnapshotSnake;
+
+typedef struct RenderSnapshot {
+    unsigned int tick;
+    unsigned int level;         // Changes whenever a different GameState is shown
+    unsigned int wallRevision;  // The GameState's; caches key on (level, revision)
+    unsigned int layoutRevision;
+    Vector2 worldSize;
+    int currentLevel;
+    int score;
+    int levelStartScore;
+    int levelTargetScore;
+    bool gameOver;
+    bool targetReached;
+
+    Vector2* positions;
+    Vector2* sizes;
+    EntityType* types;
+    int count;
+    int capacity;
+
+    SnapshotSnake snakes[MAX_SNAKES];
+    int snakeCount;
+    Vector2* segments;
+    int segmentCount;
+    int segmentCapacity;
+} RenderSnapshot;
+
+// Lock-free triple buffer. The simulation fills its back slot and swaps it
+// for the middle one; the renderer swaps its front slot for the middle one
+// when that's newer. Neither side ever waits, and each slot's arrays are
+// only grown by the side holding it.
+#define SNAPSHOT_FRESH 4        // Set in middle while the renderer hasn't taken it
+
+typedef struct SnapshotBuffer {
+    RenderSnapshot slots[3];
+    atomic_int middle;          // Slot index | SNAPSHOT_FRESH
+    int back;                   // Simulation's slot
+    int front;                  // Renderer's slot
+} SnapshotBuffer;
+
+// --- SPATIAL INDEX ---
+// A snapshot's entities, all but the snakes, bucketed by world tile so a
+// rectangle query only visits the tiles it covers. Snakes are the only
+// entities a step moves; the rest change through spawn, destroy or edit,
+// which bump layoutRevision, so the index is rebuilt only when that (or the
+// level) changes. Entities are reported by their index in the snapshot.
+#define SPATIAL_TILE (4 * CELL_SIZE)
+
+typedef void (*SpatialQueryFn)(void* user, int index);
+
+typedef struct SpatialIndex {
+    bool built;
+    unsigned int level;         // Snapshot level and layoutRevision it was built from
+    unsigned int revision;
+    Vector2 origin;             // World position of tile (0, 0)
+    float tileSize;             // SPATIAL_TILE, doubled until a sparse world fits the table
+    int cols, rows;             // 0 when nothing is indexed
+    int* tileStart;             // Tile t is items[tileStart[t] .. tileStart[t + 1])
+    int* tileFill;
+    int tileCapacity;
+    int* items;                 // Snapshot entity indices, grouped by tile
+    int itemCapacity;
+} SpatialIndex;
+
+// --- LEVEL CACHE ---
+// Parsed levels kept as authoring records, so a level that was already read
+// can be rebuilt without touching the disk. Least recently used is evicted.
+#define LEVEL_CACHE_SLOTS 8
+#define LEVEL_PATH_MAX 256
+
+typedef struct LevelImage {
+    char path[LEVEL_PATH_MAX];
+    LevelMeta meta;
+    Entity* entities;
+    int count;
+    unsigned int lastUsed;  // 0 = empty slot
+} LevelImage;
+
+typedef struct LevelCache {
+    LevelImage slots[LEVEL_CACHE_SLOTS];
+    unsigned int clock;
+} LevelCache;
+
+// --- HOT RELOAD ---
+// The records the current level was built from, each with the live entity it
+// produced. A reload diffs the new file against these records rather than the
+// live world, so pickups already eaten stay eaten unless their line changed.
+typedef struct LevelReloader {
+    Entity* records;
+    EntityHandle* handles;
+    int count;
+    int capacity;
+
+    // Scratch reused across reloads
+    Entity* incoming;
+    EntityHandle* incomingHandles;
+    int incomingCount;
+    int incomingCapacity;
+    int* table;             // Open-addressed: one record per distinct key, -1 = empty
+    int* heads;             // Per slot: next unmatched record with that key, -1 = none
+    int* next;              // Per record: next record with the same key
+    bool* matched;
+    int tableSize;
+} LevelReloader;
+
+typedef struct LevelDiff {
+    int unchanged;
+    int added;
+    int removed;
+    int changed;
+} LevelDiff;
+
+// Watches a level file (inotify on Linux) so edits are picked up on save
+typedef struct LevelWatcher {
+    int fd;                 // -1 when watching isn't available
+    int wd;
+    char name[LEVEL_PATH_MAX];
+} LevelWatcher;
+
+// --- LEVEL SEQUENCE ---
+// Plays a list of levels in order. While one level is played, a worker thread
+// builds the next one into a spare GameState; advancing swaps the two.
+typedef struct LevelSequence {
+    const char* const* paths;   // Caller-owned playlist
+    int count;
+    int current;                // Index of the level in active
+
+    GameState* active;          // The level being played (owner thread only)
+    GameState* spare;           // Owned by the worker while a prefetch is pending
+
+    LevelCache cache;
+    LevelReloader reload;       // Tracks the active level for incremental reloads
+    pthread_t worker;
+    pthread_mutex_t lock;       // Guards cache, spare and the fields below
+    pthread_cond_t wake;        // Main -> worker: new request or quit
+    pthread_cond_t done;        // Worker -> main: a request finished
+    int pendingIndex;           // Level the worker should build, -1 if none
+    int readyIndex;             // Level built into spare, -1 if none
+    bool readyOk;               // readyIndex loaded; false leaves spare unplayable
+    bool working;               // Worker is building into spare right now
+    bool quit;
+} LevelSequence;
+
+// --- SIMULATION THREAD ---
+// The game's levels are played on their own thread at SIM_TICK_RATE. Input
+// comes in through a single-producer single-consumer ring of commands and
+// every tick goes out as a RenderSnapshot, so a slow frame and a slow tick
+// never hold each other up.
+#define SIM_COMMAND_QUEUE 64    // Power of two
+
+typedef enum SimCommandType {
+    SIM_TURN,                   // turn is the new direction
+    SIM_RESTART,                // After a game over
+    SIM_RELOAD                  // Re-read the current level file
+} SimCommandType;
+
+typedef struct SimCommand {
+    SimCommandType type;
+    Vector2 turn;
+} SimCommand;
+
+typedef struct SimCommandQueue {
+    SimCommand items[SIM_COMMAND_QUEUE];
+    atomic_uint head;           // Next to pop; written by the simulation
+    atomic_uint tail;           // Next to push; written by the renderer
+} SimCommandQueue;
+
+typedef struct Simulation {
+    LevelSequence levels;       // Only touched by the simulation thread once started
+    LevelWatcher watcher;
+    SimCommandQueue commands;
+    SnapshotBuffer snapshots;
+    const GameState* shown;     // Level the snapshots' level serial refers to
+    unsigned int level;
+    pthread_t thread;
+    atomic_bool quit;
+} Simulation;
+
+// --- LEVEL PACKS ---
+// Many levels in one mapped file (.engp), found by name through a hash index
+// stored in the file. "pack.engp:name" (or "pack.engp:#index") is a level path
+// LoadLevel understands; packs opened that way stay mapped until FreeLevelPacks.
+#define LEVEL_PACKS_OPEN 4
+
+typedef struct LevelPack {
+    void* map;
+    size_t mapSize;
+    const void* entries;
+    const uint32_t* index;  // Name hash -> entry + 1, 0 = empty
+    uint32_t indexMask;
+    const char* names;
+    int count;
+    uint64_t fileDevice, fileInode;  // The file as mapped, to notice a rewrite
+    int64_t fileTime;
+} LevelPack;
+
+// --- LEVEL VALIDATION ---
+// Static checks on a level without playing it: the snake spawn is clear and
+// enough points are reachable from it to meet META TARGET.
+typedef enum LevelProblem {
+    LEVEL_OK = 0,
+    LEVEL_LOAD_FAILED,
+    LEVEL_NO_SNAKE,
+    LEVEL_SPAWN_BLOCKED,        // Spawn overlaps a wall or lies outside the world
+    LEVEL_TARGET_UNREACHABLE,   // Reachable points < META TARGET
+} LevelProblem;
+
+typedef struct LevelReport {
+    const char* path;
+    LevelProblem problem;
+    int targetScore;
+    int pickups;                // Apples and coins
+    int reachablePickups;
+    int totalPoints;
+    int reachablePoints;
+    int reachableCells;
+    double seconds;
+} LevelReport;
+
+// --- LOGGING ---
+// One progress line, without its newline
+typedef void (*EngineLogFn)(const char* message);
+
 // --- PROTOTYPES ---
-void InitSnake(SnakeData* s, Vector2 startPos);
+void SetEngineLog(EngineLogFn log);
+void EngineLog(const char* format, ...) __attribute__((format(printf, 1, 2)));
+void EngineError(const char* format, ...) __attribute__((format(printf, 1, 2)));
+void* ArenaAlloc(Arena* arena, size_t bytes);
+void ArenaReset(Arena* arena);
+void ArenaFree(Arena* arena);
+
+int CellAt(Vector2 pos);
+void OccupancyAdd(OccupancyGrid* g, OccupancyLayer layer, int cell);
+void OccupancyRemove(OccupancyGrid* g, OccupancyLayer layer, int cell);
+bool OccupancyTest(const OccupancyGrid* g, OccupancyLayer layer, int cell);
+bool OccupancyTestRect(const OccupancyGrid* g, unsigned int layerMask, Vector2 pos, Vector2 size);
+
+void InitSnake(SnakeData* s, Vector2 startPos, Arena* arena, int capacity, OccupancyGrid* occupancy);
 void AppendSnake(SnakeData* s, Vector2 newPart);
-void MoveSnake(SnakeData* s);
+void MoveSnake(SnakeData* s, Vector2 bounds);
+Vector2 SnakeSegment(const SnakeData* s, int i);
+Vector2 SnakeHead(const SnakeData* s);
+Vector2 SnakeTail(const SnakeData* s);
+SnakeIterator SnakeBegin(const SnakeData* s);
+bool SnakeNext(SnakeIterator* it, Vector2* segment);
+int CopySnakeSegments(const SnakeData* s, Vector2* out);
 
-Entity* SpawnEntity(GameState* state, EntityType type, Vector2 pos, Vector2 size);
-void PushEvent(GameState* state, EventType type, Entity* a, Entity* b);
+EntityHandle SpawnEntity(GameState* state, EntityType type, Vector2 pos, Vector2 size);
+void DestroyEntity(GameState* state, EntityHandle h);
+bool IsAlive(const GameState* state, EntityHandle h);
+EntityHandle HandleOf(const GameState* state, int id);
+SnakeData* GetSnake(GameState* state, int id);
+AppleData* GetApple(GameState* state, int id);
+EnemyData* GetEnemy(GameState* state, int id);
+void QueueEvent(EventQueue* q, Event e);
+void ClearEventQueue(EventQueue* q);
+void MergeEventQueues(EventQueue* dst, EventQueue* const* src, int n);
+void FreeEventQueue(EventQueue* q);
+void PushEvent(GameState* state, Event e);
+bool LayersInteract(EntityType a, EntityType b);
+bool SnakeBitesSelf(const SnakeData* s);
 void ResolveCollisions(GameState* state);
+void UpdateSpatialIndex(SpatialIndex* index, const RenderSnapshot* snap);
+void QuerySpatialIndex(const SpatialIndex* index, const RenderSnapshot* snap, Vector2 pos, Vector2 size, SpatialQueryFn onEntity, void* user);
+void FreeSpatialIndex(SpatialIndex* index);
 void ProcessEvents(GameState* state);
-void CheckLevelProgression(GameState* state);
-void LoadLevel(GameState* state, const char* filename);
+void StepWorld(GameState* state, InputFrame input);
+bool CheckLevelProgression(const GameState* state);
+LevelMeta DefaultLevelMeta(void);
+LevelMeta LevelMetaOf(const GameState* state);
+void ApplyLevelMeta(GameState* state, LevelMeta meta);
+void ResetLevel(GameState* state);
+EntityHandle SpawnLevelEntity(GameState* state, const Entity* def, bool trackWalls);
+Entity EntityRecordOf(const GameState* state, int id);
+void UpdateLevelEntity(GameState* state, EntityHandle handle, const Entity* def);
+bool HasExtension(const char* filename, const char* ext);
+bool LoadLevel(GameState* state, const char* filename);
+bool ReadLevelRecords(const char* path, GameState* scratch, LevelMeta* meta, LevelEntityFn onEntity, void* user);
+void UnloadGameState(GameState* state);
+
+// level_text.c
+EntityType EntityTypeFromChar(char c);
+char EntityTypeChar(EntityType type);
+bool ParseLevelText(const char* text, size_t length, LevelMeta* meta, LevelEntityFn onEntity, void* user, LevelError* error);
+bool LoadLevelTextMemory(GameState* state, const char* text, size_t length, LevelError* error);
+bool ParseLevelFile(const char* filename, LevelMeta* meta, LevelEntityFn onEntity, void* user, LevelError* error);
+void PrintLevelError(const char* filename, LevelError error);
+bool LoadLevelText(GameState* state, const char* filename);
+bool SaveLevelText(const GameState* state, const char* filename);
+bool SaveLevelRecords(const Entity* records, int count, LevelMeta meta, const char* filename);
+
+// level_cache.c
+void CaptureLevel(LevelCache* cache, const char* path, const GameState* state);
+bool InstantiateCachedLevel(LevelCache* cache, const char* path, GameState* state);
+bool CopyCachedLevel(LevelCache* cache, const char* path, LevelImage* copy);
+void InstantiateLevelImage(const LevelImage* img, GameState* state);
+void InvalidateCachedLevel(LevelCache* cache, const char* path);
+void FreeLevelCache(LevelCache* cache);
+
+// level_reload.c
+void TrackLoadedLevel(LevelReloader* r, const GameState* state);
+bool ApplyLevelChanges(LevelReloader* r, GameState* state, const char* filename, LevelDiff* diff);
+void FreeLevelReloader(LevelReloader* r);
+
+// level_watch.c
+void InitLevelWatcher(LevelWatcher* w);
+bool WatchLevelFile(LevelWatcher* w, const char* path);
+bool LevelFileChanged(LevelWatcher* w);
+void FreeLevelWatcher(LevelWatcher* w);
+
+// level_sequence.c
+bool InitLevelSequence(LevelSequence* seq, const char* const* paths, int count);
+bool AdvanceLevel(LevelSequence* seq);
+bool RestartLevelSequence(LevelSequence* seq);
+void ReloadCurrentLevel(LevelSequence* seq);
+void FreeLevelSequence(LevelSequence* seq);
+
+// simulation.c
+bool CaptureSnapshot(RenderSnapshot* snap, const GameState* state);
+void FreeSnapshot(RenderSnapshot* snap);
+bool PushSimCommand(SimCommandQueue* q, SimCommand c);
+bool PopSimCommand(SimCommandQueue* q, SimCommand* c);
+bool StartSimulation(Simulation* sim, const char* const* paths, int count);
+const RenderSnapshot* LatestSnapshot(Simulation* sim);
+void StopSimulation(Simulation* sim);
+
+// level_chunks.c
+bool LoadLevelChunked(GameState* state, const char* filename);
+void UpdateChunkStream(GameState* state);
+void FreeChunkStream(GameState* state);
+bool ReadLevelChunked(const char* filename, LevelMeta* meta, LevelEntityFn onEntity, void* user);
+bool SaveLevelChunked(const Entity* records, int count, LevelMeta meta, const char* filename, int chunkCells);
+
+// level_pack.c
+bool OpenLevelPack(LevelPack* pack, const char* filename);
+void CloseLevelPack(LevelPack* pack);
+int FindPackedLevel(const LevelPack* pack, const char* name);
+const char* PackedLevelName(const LevelPack* pack, int index);
+bool LoadPackedLevel(GameState* state, const LevelPack* pack, int index);
+bool IsPackedLevelPath(const char* path);
+bool LoadLevelFromPack(GameState* state, const char* path);
+char** ListPackedLevels(const char* filename, int* count);
+void FreeLevelPacks(void);
+bool SaveLevelPack(const char* filename, const char* const* paths, int count, bool compress);
+
+// level_validate.c
+void ValidateLevels(const char* const* paths, int count, int threads, LevelReport* reports);
+const char* LevelProblemName(LevelProblem problem);
+void PrintLevelReports(FILE* out, const LevelReport* reports, int count, bool timing);
+
+// level_binary.c
+bool LoadLevelBinary(GameState* state, const char* filename);
+bool LoadLevelBinaryMemory(GameState* state, const void* data, size_t size);
+bool SaveLevelBinary(const GameState* state, const char* filename, bool bakeWalls);
 
 #endif
\ No newline at end of file
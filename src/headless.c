@@ -0,0 +1,155 @@
+#include "game_types.h"
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+// Headless runner: plays levels with a built-in bot at full CPU speed.
+// No window, no raylib; links only against the engine library.
+//
+//   headless [--ticks N] [--brute] [--sequence] level.eng...
+//   headless --validate [--threads N] [--timing] level.eng...|levels.engp
+//
+// Levels are played independently with a fresh score, or with --sequence
+// back to back like the game: progression, carried score, prefetching.
+// --validate plays nothing: it checks every level's spawn and reachable
+// points on all cores and prints a JSON report. stdout carries only results;
+// the engine reports load problems on stderr.
+
+static double NowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// --- BOT ---
+// Greedy: of the moves that don't run into a wall, an enemy or the body,
+// take the one that brings the head closest to the nearest pickup.
+static InputFrame ChooseInput(const GameState* state) {
+    InputFrame input = {0};
+    if (state->snakeCount == 0) return input;
+
+    // Only steer on the tick the snake actually moves, so two turns can't
+    // stack up between moves into a reversal
+    const SnakeData* s = &state->snakes[0];
+    if (s->moveTimer + SIM_DT < state->levelBaseSpeed) return input;
+
+    Vector2 head = SnakeHead(s);
+    Vector2 size = state->sizes[state->snakeOwner[0]];
+
+    Vector2 target = head;
+    float nearest = -1.0f;
+    for (int k = 0; k < state->appleCount; k++) {
+        Vector2 p = state->positions[state->appleOwner[k]];
+        float d = fabsf(p.x - head.x) + fabsf(p.y - head.y);
+        if (nearest < 0 || d < nearest) { nearest = d; target = p; }
+    }
+
+    static const Vector2 dirs[4] = { {0, -1}, {1, 0}, {0, 1}, {-1, 0} };
+    unsigned int blocking = OCC_BIT(OCC_WALL) | OCC_BIT(OCC_ENEMY) | OCC_BIT(OCC_SNAKE);
+    float best = -1.0f;
+    for (int i = 0; i < 4; i++) {
+        Vector2 d = dirs[i];
+        if (d.x == -s->direction.x && d.y == -s->direction.y) continue;
+
+        Vector2 next = { head.x + d.x * CELL_SIZE, head.y + d.y * CELL_SIZE };
+        if (OccupancyTestRect(&state->occupancy, blocking, next, size)) continue;
+
+        float score = fabsf(target.x - next.x) + fabsf(target.y - next.y);
+        if (best < 0 || score < best) { best = score; input.turn = d; }
+    }
+    return input;
+}
+
+// --- RUNNER ---
+static void PlayLevel(GameState* state, const char* path, unsigned int maxTicks) {
+    double start = NowSeconds();
+    while (state->tick < maxTicks && !state->gameOver && !CheckLevelProgression(state)) {
+        StepWorld(state, ChooseInput(state));
+    }
+    double elapsed = NowSeconds() - start;
+
+    const char* result = state->gameOver ? "dead" : CheckLevelProgression(state) ? "cleared" : "timeout";
+    printf("level=%s ticks=%u score=%d target=%d result=%s ticks_per_sec=%.0f events_peak=%d\n",
+           path, state->tick, state->score, state->levelTargetScore, result,
+           elapsed > 0 ? state->tick / elapsed : 0.0, state->events.highWater);
+}
+
+static void LoadFailed(const char* path) {
+    printf("level=%s result=load_failed\n", path);
+}
+
+static int RunSequence(const char* const* levels, int count, unsigned int maxTicks, bool brute) {
+    LevelSequence seq;
+    if (!InitLevelSequence(&seq, levels, count)) { LoadFailed(levels[0]); return 1; }
+    seq.active->bruteForceCollisions = brute;
+
+    do {
+        PlayLevel(seq.active, levels[seq.current], maxTicks);
+    } while (CheckLevelProgression(seq.active) && AdvanceLevel(&seq));
+
+    FreeLevelSequence(&seq);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    unsigned int maxTicks = 60 * SIM_TICK_RATE;
+    bool brute = false;
+    bool sequence = false;
+    bool validate = false;
+    bool timing = false;
+    int threads = 0;
+    int firstLevel = argc;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) maxTicks = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--brute") == 0) brute = true;
+        else if (strcmp(argv[i], "--sequence") == 0) sequence = true;
+        else if (strcmp(argv[i], "--validate") == 0) validate = true;
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--timing") == 0) timing = true;
+        else if (strncmp(argv[i], "--", 2) == 0) break;  // Unknown option: usage
+        else { firstLevel = i; break; }
+    }
+    if (firstLevel >= argc) {
+        fprintf(stderr, "usage: %s [--ticks N] [--brute] [--sequence] level.eng...|levels.engp\n"
+                        "       %s --validate [--threads N] level.eng...|levels.engp\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    // A lone pack stands for every level in it
+    const char* const* levels = (const char* const*)(argv + firstLevel);
+    int levelCount = argc - firstLevel;
+    char** packed = NULL;
+    if (levelCount == 1 && HasExtension(levels[0], ".engp")) {
+        packed = ListPackedLevels(levels[0], &levelCount);
+        if (!packed) return 1;
+        levels = (const char* const*)packed;
+    }
+
+    int status = 0;
+    if (validate) {
+        LevelReport* reports = (LevelReport*)calloc(levelCount ? levelCount : 1, sizeof(LevelReport));
+        if (!reports) return 1;
+        ValidateLevels(levels, levelCount, threads, reports);
+        PrintLevelReports(stdout, reports, levelCount, timing);
+        for (int i = 0; i < levelCount; i++) if (reports[i].problem != LEVEL_OK) status = 1;
+        free(reports);
+    } else if (sequence) {
+        status = RunSequence(levels, levelCount, maxTicks, brute);
+    } else {
+        GameState* state = (GameState*)calloc(1, sizeof(GameState));
+        if (!state) return 1;
+        for (int i = 0; i < levelCount; i++) {
+            // A level that doesn't load is reported and skipped
+            if (!LoadLevel(state, levels[i])) { LoadFailed(levels[i]); status = 1; continue; }
+            state->score = 0;
+            state->bruteForceCollisions = brute;
+            PlayLevel(state, levels[i], maxTicks);
+        }
+        UnloadGameState(state);
+        free(state);
+    }
+    FreeLevelPacks();
+    ENGINE_FREE(packed);
+    return status;
+}
@@ -0,0 +1,176 @@
+#include "game_types.h"
+#include <string.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// --- BINARY LEVEL FORMAT (.engb) ---
+// A compiled level is the engine's own entity arrays written back to back,
+// so loading is validation plus a walk over the arrays; nothing is parsed.
+//
+//   EngbHeader
+//   Vector2          positions[entityCount]
+//   Vector2          sizes[entityCount]
+//   int32_t          types[entityCount]       (EntityType)
+//   EntityProperties properties[entityCount]
+//   uint16_t         wallCounts[gridCols * gridRows]   (optional, gridOffset != 0)
+//
+// All blocks are 4-byte aligned and in host byte order. Files are mapped
+// and validated in place, then copied into the state's arrays. Version 1
+// files end the header before the world size and load with a screen-sized
+// world.
+#define ENGB_MAGIC "ENGB"
+#define ENGB_VERSION 2
+
+typedef struct EngbHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t fileSize;
+    uint32_t entityCount;
+    uint32_t positionsOffset;
+    uint32_t sizesOffset;
+    uint32_t typesOffset;
+    uint32_t propertiesOffset;
+    uint32_t gridOffset;        // 0 when no wall grid is baked in
+    uint16_t gridCols;
+    uint16_t gridRows;
+
+    // META block
+    int32_t targetScore;
+    float baseSpeed;
+    float worldWidth;           // Version 2
+    float worldHeight;
+} EngbHeader;
+
+_Static_assert(sizeof(EntityType) == sizeof(int32_t), "types block is stored as int32");
+_Static_assert(sizeof(EntityProperties) == 12, "properties block layout");
+
+static bool BlockInBounds(uint32_t offset, uint64_t bytes, size_t headerSize, size_t size) {
+    return (offset & 3) == 0 && offset >= headerSize && offset + bytes <= size;
+}
+
+// Fills a state that ResetLevel has just cleared. Returns false, leaving the
+// state empty, if the data isn't a well-formed .engb image.
+bool LoadLevelBinaryMemory(GameState* state, const void* data, size_t size) {
+    const unsigned char* base = (const unsigned char*)data;
+    const size_t v1Size = offsetof(EngbHeader, worldWidth);
+    if (size < v1Size) return false;
+
+    const EngbHeader* h = (const EngbHeader*)base;
+    uint64_t n = h->entityCount;
+    if (memcmp(h->magic, ENGB_MAGIC, 4) != 0 || (h->version != 1 && h->version != ENGB_VERSION) || h->fileSize != size) return false;
+    size_t headerSize = h->version == 1 ? v1Size : sizeof(EngbHeader);
+    if (size < headerSize) return false;
+    if (!BlockInBounds(h->positionsOffset, n * sizeof(Vector2), headerSize, size) ||
+        !BlockInBounds(h->sizesOffset, n * sizeof(Vector2), headerSize, size) ||
+        !BlockInBounds(h->typesOffset, n * sizeof(int32_t), headerSize, size) ||
+        !BlockInBounds(h->propertiesOffset, n * sizeof(EntityProperties), headerSize, size)) return false;
+
+    const Vector2* positions = (const Vector2*)(base + h->positionsOffset);
+    const Vector2* sizes = (const Vector2*)(base + h->sizesOffset);
+    const int32_t* types = (const int32_t*)(base + h->typesOffset);
+    const EntityProperties* props = (const EntityProperties*)(base + h->propertiesOffset);
+    for (uint64_t i = 0; i < n; i++) {
+        if (types[i] <= ENTITY_NONE || types[i] > ENTITY_COIN) return false;
+    }
+
+    // A baked wall grid is only usable if it was built for this grid size
+    const uint16_t* wallCounts = NULL;
+    if (h->gridOffset && h->gridCols == GRID_COLS && h->gridRows == GRID_ROWS &&
+        BlockInBounds(h->gridOffset, TOTAL_CELLS * sizeof(uint16_t), headerSize, size)) {
+        wallCounts = (const uint16_t*)(base + h->gridOffset);
+    }
+
+    state->levelTargetScore = h->targetScore;
+    state->levelBaseSpeed = h->baseSpeed;
+    if (h->version >= 2 && h->worldWidth > 0 && h->worldHeight > 0) {
+        state->worldSize = (Vector2){ h->worldWidth, h->worldHeight };
+    }
+
+    for (uint64_t i = 0; i < n; i++) {
+        Entity def = { true, (EntityType)types[i], positions[i], sizes[i], props[i].value, props[i].subtype, props[i].speed };
+        SpawnLevelEntity(state, &def, wallCounts == NULL);
+    }
+
+    if (wallCounts) {
+        memcpy(state->occupancy.counts[OCC_WALL], wallCounts, TOTAL_CELLS * sizeof(uint16_t));
+        memset(state->occupancy.bits[OCC_WALL], 0, sizeof(state->occupancy.bits[OCC_WALL]));
+        for (int c = 0; c < TOTAL_CELLS; c++) {
+            if (wallCounts[c]) state->occupancy.bits[OCC_WALL][c >> 6] |= 1ull << (c & 63);
+        }
+    }
+    return true;
+}
+
+bool LoadLevelBinary(GameState* state, const char* filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) { EngineError("Failed to load %s", filename); return false; }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); EngineError("Failed to load %s", filename); return false; }
+
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) { EngineError("Failed to load %s", filename); return false; }
+
+    bool ok = LoadLevelBinaryMemory(state, data, (size_t)st.st_size);
+    munmap(data, (size_t)st.st_size);
+    if (!ok) EngineError("Invalid binary level %s", filename);
+    return ok;
+}
+
+// --- WRITER ---
+// Writes every live entity in alive[] order. bakeWalls stores the current
+// wall occupancy so loaders can skip rasterising walls.
+bool SaveLevelBinary(const GameState* state, const char* filename, bool bakeWalls) {
+    uint32_t n = (uint32_t)state->aliveCount;
+
+    EngbHeader h = {0};
+    memcpy(h.magic, ENGB_MAGIC, 4);
+    h.version = ENGB_VERSION;
+    h.entityCount = n;
+    h.positionsOffset = sizeof(EngbHeader);
+    h.sizesOffset = h.positionsOffset + n * sizeof(Vector2);
+    h.typesOffset = h.sizesOffset + n * sizeof(Vector2);
+    h.propertiesOffset = h.typesOffset + n * sizeof(int32_t);
+    uint32_t end = h.propertiesOffset + n * sizeof(EntityProperties);
+    if (bakeWalls) {
+        h.gridOffset = end;
+        h.gridCols = GRID_COLS;
+        h.gridRows = GRID_ROWS;
+        end += TOTAL_CELLS * sizeof(uint16_t);
+        end = (end + 3) & ~3u;
+    }
+    h.fileSize = end;
+    h.targetScore = state->levelTargetScore;
+    h.baseSpeed = state->levelBaseSpeed;
+    h.worldWidth = state->worldSize.x;
+    h.worldHeight = state->worldSize.y;
+
+    unsigned char* image = (unsigned char*)ENGINE_MALLOC(end);
+    if (!image) return false;
+    memset(image, 0, end);
+    memcpy(image, &h, sizeof(h));
+
+    Vector2* positions = (Vector2*)(image + h.positionsOffset);
+    Vector2* sizes = (Vector2*)(image + h.sizesOffset);
+    int32_t* types = (int32_t*)(image + h.typesOffset);
+    EntityProperties* props = (EntityProperties*)(image + h.propertiesOffset);
+    for (uint32_t k = 0; k < n; k++) {
+        int id = state->alive[k];
+        positions[k] = state->positions[id];
+        sizes[k] = state->sizes[id];
+        types[k] = state->types[id];
+        props[k] = state->properties[id];
+    }
+    if (bakeWalls) memcpy(image + h.gridOffset, state->occupancy.counts[OCC_WALL], TOTAL_CELLS * sizeof(uint16_t));
+
+    FILE* file = fopen(filename, "wb");
+    bool ok = file && fwrite(image, 1, end, file) == end;
+    if (file) ok = (fclose(file) == 0) && ok;
+    ENGINE_FREE(image);
+    if (!ok) EngineError("Could not save file to: %s", filename);
+    return ok;
+}
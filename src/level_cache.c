@@ -0,0 +1,86 @@
+#include "game_types.h"
+#include <string.h>
+
+// --- LEVEL CACHE ---
+// An image is captured from a freshly loaded state: alive[] is still in file
+// order and properties[] holds every authoring field, so replaying the
+// records through SpawnLevelEntity rebuilds the same level whatever format
+// it was loaded from.
+
+static LevelImage* FindImage(LevelCache* cache, const char* path) {
+    for (int i = 0; i < LEVEL_CACHE_SLOTS; i++) {
+        LevelImage* img = &cache->slots[i];
+        if (img->lastUsed && strcmp(img->path, path) == 0) return img;
+    }
+    return NULL;
+}
+
+static void ClearImage(LevelImage* img) {
+    ENGINE_FREE(img->entities);
+    *img = (LevelImage){0};
+}
+
+void CaptureLevel(LevelCache* cache, const char* path, const GameState* state) {
+    if (strlen(path) >= LEVEL_PATH_MAX) return;
+
+    // Reuse the entry for this path, else an empty slot, else the LRU one
+    LevelImage* img = FindImage(cache, path);
+    if (!img) {
+        img = &cache->slots[0];
+        for (int i = 0; i < LEVEL_CACHE_SLOTS && img->lastUsed; i++) {
+            if (cache->slots[i].lastUsed < img->lastUsed) img = &cache->slots[i];
+        }
+    }
+
+    // An evicted image's buffer is reused; empty slots hold NULL
+    Entity* entities = (Entity*)ENGINE_REALLOC(img->entities, (state->aliveCount ? state->aliveCount : 1) * sizeof(Entity));
+    if (!entities) { ClearImage(img); return; }
+
+    for (int k = 0; k < state->aliveCount; k++) entities[k] = EntityRecordOf(state, state->alive[k]);
+    strcpy(img->path, path);
+    img->entities = entities;
+    img->count = state->aliveCount;
+    img->meta = LevelMetaOf(state);
+    img->lastUsed = ++cache->clock;
+}
+
+void InstantiateLevelImage(const LevelImage* img, GameState* state) {
+    ResetLevel(state);
+    ApplyLevelMeta(state, img->meta);
+    for (int k = 0; k < img->count; k++) SpawnLevelEntity(state, &img->entities[k], true);
+}
+
+// Rebuilds a cached level into state. Returns false (state untouched) on a miss.
+bool InstantiateCachedLevel(LevelCache* cache, const char* path, GameState* state) {
+    LevelImage* img = FindImage(cache, path);
+    if (!img) return false;
+    InstantiateLevelImage(img, state);
+    img->lastUsed = ++cache->clock;
+    return true;
+}
+
+// Copies a cached level into copy, whose buffer the caller owns and reuses,
+// so it can be instantiated without holding the cache's lock. Returns false
+// on a miss, or if the copy can't grow.
+bool CopyCachedLevel(LevelCache* cache, const char* path, LevelImage* copy) {
+    LevelImage* img = FindImage(cache, path);
+    if (!img) return false;
+    Entity* entities = (Entity*)ENGINE_REALLOC(copy->entities, (img->count ? img->count : 1) * sizeof(Entity));
+    if (!entities) return false;
+
+    memcpy(entities, img->entities, (size_t)img->count * sizeof(Entity));
+    img->lastUsed = ++cache->clock;
+    *copy = *img;
+    copy->entities = entities;
+    return true;
+}
+
+void InvalidateCachedLevel(LevelCache* cache, const char* path) {
+    LevelImage* img = FindImage(cache, path);
+    if (img) ClearImage(img);
+}
+
+void FreeLevelCache(LevelCache* cache) {
+    for (int i = 0; i < LEVEL_CACHE_SLOTS; i++) ClearImage(&cache->slots[i]);
+    cache->clock = 0;
+}
@@ -0,0 +1,387 @@
+#include "game_types.h"
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// --- CHUNKED LEVEL FORMAT (.engc) ---
+// The world is cut into square chunks of chunkCells x chunkCells cells and
+// each chunk's records are stored together, so a chunk is one contiguous run
+// of the mapped file:
+//
+//   EngcHeader
+//   EngcChunk  chunks[chunksX * chunksY]   (row-major)
+//   EngcRecord records[recordCount]        (globals first, then chunk by chunk)
+//
+// Snakes are global: they are spawned once and never unloaded. Walls are
+// split at chunk edges so every piece belongs to exactly one chunk; anything
+// else belongs to the chunk its position falls in.
+#define ENGC_MAGIC "ENGC"
+#define ENGC_VERSION 1
+
+typedef struct EngcHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t fileSize;
+    uint32_t chunkCells;
+    uint32_t chunksX;
+    uint32_t chunksY;
+    uint32_t chunkTableOffset;
+    uint32_t recordsOffset;
+    uint32_t recordCount;
+    uint32_t globalCount;
+    uint32_t maxChunkRecords;   // Largest chunk, sizes the resident window
+
+    // META block
+    int32_t targetScore;
+    float baseSpeed;
+    float worldWidth;
+    float worldHeight;
+} EngcHeader;
+
+typedef struct EngcChunk {
+    uint32_t first;
+    uint32_t count;
+} EngcChunk;
+
+typedef struct EngcRecord {
+    Vector2 position;
+    Vector2 size;
+    int32_t type;
+    EntityProperties properties;
+} EngcRecord;
+
+_Static_assert(sizeof(EngcRecord) == 32, "record layout");
+
+static Entity EntityFromRecord(const EngcRecord* r) {
+    return (Entity){ true, (EntityType)r->type, r->position, r->size,
+                     r->properties.value, r->properties.subtype, r->properties.speed };
+}
+
+static bool RecordTypeValid(const EngcRecord* r) {
+    return r->type > ENTITY_NONE && r->type <= ENTITY_COIN;
+}
+
+// Validates the header and chunk table; records are checked as they spawn
+static const EngcHeader* CheckChunkedImage(const void* data, size_t size) {
+    if (size < sizeof(EngcHeader)) return NULL;
+    const EngcHeader* h = (const EngcHeader*)data;
+    if (memcmp(h->magic, ENGC_MAGIC, 4) != 0 || h->version != ENGC_VERSION || h->fileSize != size) return NULL;
+    if (h->chunkCells == 0 || h->chunksX == 0 || h->chunksY == 0) return NULL;
+
+    uint64_t chunkCount = (uint64_t)h->chunksX * h->chunksY;
+    if ((h->chunkTableOffset & 3) || h->chunkTableOffset < sizeof(EngcHeader) ||
+        h->chunkTableOffset + chunkCount * sizeof(EngcChunk) > size) return NULL;
+    if ((h->recordsOffset & 3) || h->recordsOffset < sizeof(EngcHeader) ||
+        h->recordsOffset + (uint64_t)h->recordCount * sizeof(EngcRecord) > size) return NULL;
+    if (h->globalCount > h->recordCount) return NULL;
+
+    const EngcChunk* chunks = (const EngcChunk*)((const unsigned char*)data + h->chunkTableOffset);
+    for (uint64_t c = 0; c < chunkCount; c++) {
+        if (chunks[c].first < h->globalCount || chunks[c].count > h->maxChunkRecords ||
+            (uint64_t)chunks[c].first + chunks[c].count > h->recordCount) return NULL;
+    }
+    return h;
+}
+
+static void* MapLevelFile(const char* filename, size_t* size) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return NULL; }
+
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+    *size = (size_t)st.st_size;
+    return data;
+}
+
+// --- STREAMING ---
+static bool RecordConsumed(const ChunkStream* s, uint32_t record) {
+    return (s->consumed[record >> 3] >> (record & 7)) & 1;
+}
+
+// Destroys what is left of a chunk. An entity that died while resident was
+// eaten (or otherwise destroyed in play) and must not come back.
+static void UnloadChunk(GameState* state, ResidentChunk* rc) {
+    ChunkStream* s = state->stream;
+    const EngcChunk* chunks = (const EngcChunk*)s->chunkTable;
+    uint32_t first = chunks[rc->index].first;
+    for (int i = 0; i < rc->count; i++) {
+        EntityHandle h = rc->handles[i];
+        if (h.index < 0) continue;
+        if (IsAlive(state, h)) DestroyEntity(state, h);
+        else s->consumed[(first + i) >> 3] |= (uint8_t)(1u << ((first + i) & 7));
+    }
+    rc->index = -1;
+    rc->count = 0;
+}
+
+static void LoadChunk(GameState* state, ResidentChunk* rc, int index) {
+    ChunkStream* s = state->stream;
+    const EngcChunk* chunk = &((const EngcChunk*)s->chunkTable)[index];
+    const EngcRecord* records = (const EngcRecord*)s->records;
+    rc->index = index;
+    rc->count = (int)chunk->count;
+    for (uint32_t i = 0; i < chunk->count; i++) {
+        uint32_t r = chunk->first + i;
+        rc->handles[i] = NULL_HANDLE;
+        if (RecordConsumed(s, r) || !RecordTypeValid(&records[r])) continue;
+        Entity def = EntityFromRecord(&records[r]);
+        rc->handles[i] = SpawnLevelEntity(state, &def, true);
+    }
+}
+
+static bool InWindow(const ChunkStream* s, int index) {
+    int cx = index % s->chunksX, cy = index / s->chunksX;
+    return abs(cx - s->focusX) <= STREAM_RADIUS && abs(cy - s->focusY) <= STREAM_RADIUS;
+}
+
+// Keeps the chunks around the first snake's head resident. Does nothing
+// until the head crosses into another chunk.
+void UpdateChunkStream(GameState* state) {
+    ChunkStream* s = state->stream;
+    if (!s || state->snakeCount == 0) return;
+
+    float chunkPixels = (float)(s->chunkCells * CELL_SIZE);
+    Vector2 head = SnakeHead(&state->snakes[0]);
+    int fx = (int)floorf(head.x / chunkPixels);
+    int fy = (int)floorf(head.y / chunkPixels);
+    fx = fx < 0 ? 0 : fx >= s->chunksX ? s->chunksX - 1 : fx;
+    fy = fy < 0 ? 0 : fy >= s->chunksY ? s->chunksY - 1 : fy;
+    if (fx == s->focusX && fy == s->focusY) return;
+    s->focusX = fx;
+    s->focusY = fy;
+
+    // Unload first so the slots (and entity slots) are free for the new chunks
+    for (int i = 0; i < MAX_RESIDENT_CHUNKS; i++) {
+        if (s->resident[i].index >= 0 && !InWindow(s, s->resident[i].index)) UnloadChunk(state, &s->resident[i]);
+    }
+
+    for (int cy = fy - STREAM_RADIUS; cy <= fy + STREAM_RADIUS; cy++) {
+        for (int cx = fx - STREAM_RADIUS; cx <= fx + STREAM_RADIUS; cx++) {
+            if (cx < 0 || cy < 0 || cx >= s->chunksX || cy >= s->chunksY) continue;
+            int index = cy * s->chunksX + cx;
+            ResidentChunk* slot = NULL;
+            bool loaded = false;
+            for (int i = 0; i < MAX_RESIDENT_CHUNKS && !loaded; i++) {
+                if (s->resident[i].index == index) loaded = true;
+                else if (!slot && s->resident[i].index < 0) slot = &s->resident[i];
+            }
+            if (!loaded && slot) LoadChunk(state, slot, index);
+        }
+    }
+}
+
+// Releases the stream. The entities it spawned belong to the state and go
+// with the next ResetLevel.
+void FreeChunkStream(GameState* state) {
+    ChunkStream* s = state->stream;
+    if (!s) return;
+    if (s->map) munmap(s->map, s->mapSize);
+    ENGINE_FREE(s->handleStorage);
+    ENGINE_FREE(s->consumed);
+    ENGINE_FREE(s);
+    state->stream = NULL;
+}
+
+// Fills a state that ResetLevel has just cleared with the globals and the
+// chunks around the first snake. The file stays mapped while the level runs.
+bool LoadLevelChunked(GameState* state, const char* filename) {
+    size_t size = 0;
+    void* data = MapLevelFile(filename, &size);
+    if (!data) { EngineError("Failed to load %s", filename); return false; }
+
+    const EngcHeader* h = CheckChunkedImage(data, size);
+    if (!h) {
+        munmap(data, size);
+        EngineError("Invalid chunked level %s", filename);
+        return false;
+    }
+
+    ChunkStream* s = (ChunkStream*)ENGINE_MALLOC(sizeof(ChunkStream));
+    if (!s) { munmap(data, size); return false; }
+    *s = (ChunkStream){
+        .map = data, .mapSize = size,
+        .chunkTable = (const unsigned char*)data + h->chunkTableOffset,
+        .records = (const unsigned char*)data + h->recordsOffset,
+        .chunkCells = (int)h->chunkCells, .chunksX = (int)h->chunksX, .chunksY = (int)h->chunksY,
+        .maxChunkRecords = (int)h->maxChunkRecords, .focusX = -1, .focusY = -1,
+    };
+    s->handleStorage = (EntityHandle*)ENGINE_MALLOC(((size_t)MAX_RESIDENT_CHUNKS * s->maxChunkRecords + 1) * sizeof(EntityHandle));
+    s->consumed = (uint8_t*)ENGINE_MALLOC(h->recordCount / 8 + 1);
+    state->stream = s;
+    if (!s->handleStorage || !s->consumed) { FreeChunkStream(state); return false; }  // Unmaps data too
+    memset(s->consumed, 0, h->recordCount / 8 + 1);
+    for (int i = 0; i < MAX_RESIDENT_CHUNKS; i++) {
+        s->resident[i] = (ResidentChunk){ -1, 0, s->handleStorage + (size_t)i * s->maxChunkRecords };
+    }
+
+    if (h->globalCount + (uint64_t)MAX_RESIDENT_CHUNKS * h->maxChunkRecords > MAX_ENTITIES) {
+        EngineError("%s: a full chunk window can exceed %d entities; some may not spawn", filename, MAX_ENTITIES);
+    }
+
+    state->levelTargetScore = h->targetScore;
+    state->levelBaseSpeed = h->baseSpeed;
+    if (h->worldWidth > 0 && h->worldHeight > 0) state->worldSize = (Vector2){ h->worldWidth, h->worldHeight };
+
+    const EngcRecord* records = (const EngcRecord*)s->records;
+    for (uint32_t i = 0; i < h->globalCount; i++) {
+        if (!RecordTypeValid(&records[i])) continue;
+        Entity def = EntityFromRecord(&records[i]);
+        SpawnLevelEntity(state, &def, true);
+    }
+    UpdateChunkStream(state);
+    return true;
+}
+
+// Replays every record of a chunked level without spawning anything (tools).
+// Walls come back split at chunk edges.
+bool ReadLevelChunked(const char* filename, LevelMeta* meta, LevelEntityFn onEntity, void* user) {
+    size_t size = 0;
+    void* data = MapLevelFile(filename, &size);
+    if (!data) { EngineError("Failed to load %s", filename); return false; }
+
+    const EngcHeader* h = CheckChunkedImage(data, size);
+    if (h) {
+        meta->targetScore = h->targetScore;
+        meta->baseSpeed = h->baseSpeed;
+        if (h->worldWidth > 0 && h->worldHeight > 0) meta->worldSize = (Vector2){ h->worldWidth, h->worldHeight };
+        const EngcRecord* records = (const EngcRecord*)((const unsigned char*)data + h->recordsOffset);
+        for (uint32_t i = 0; i < h->recordCount; i++) {
+            if (!RecordTypeValid(&records[i])) continue;
+            Entity def = EntityFromRecord(&records[i]);
+            if (onEntity) onEntity(user, &def);
+        }
+    } else {
+        EngineError("Invalid chunked level %s", filename);
+    }
+    munmap(data, size);
+    return h != NULL;
+}
+
+// --- WRITER ---
+// Pieces are bucketed by chunk with a counting sort, so records keep their
+// input order within a chunk.
+typedef struct ChunkPiece {
+    int chunk;              // -1 for globals
+    EngcRecord record;
+} ChunkPiece;
+
+typedef struct PieceList {
+    ChunkPiece* items;
+    int count;
+    int capacity;
+} PieceList;
+
+static bool PushPiece(PieceList* list, int chunk, EngcRecord record) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 256;
+        ChunkPiece* items = (ChunkPiece*)ENGINE_REALLOC(list->items, (size_t)capacity * sizeof(ChunkPiece));
+        if (!items) return false;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = (ChunkPiece){ chunk, record };
+    return true;
+}
+
+static int ClampChunk(float v, float chunkPixels, int count) {
+    int c = (int)floorf(v / chunkPixels);
+    return c < 0 ? 0 : c >= count ? count - 1 : c;
+}
+
+bool SaveLevelChunked(const Entity* records, int count, LevelMeta meta, const char* filename, int chunkCells) {
+    if (chunkCells <= 0) chunkCells = 1;
+    float chunkPixels = (float)(chunkCells * CELL_SIZE);
+    int chunksX = (int)ceilf(meta.worldSize.x / chunkPixels);
+    int chunksY = (int)ceilf(meta.worldSize.y / chunkPixels);
+    if (chunksX < 1) chunksX = 1;
+    if (chunksY < 1) chunksY = 1;
+    int chunkCount = chunksX * chunksY;
+
+    PieceList pieces = {0};
+    bool ok = true;
+    for (int i = 0; i < count && ok; i++) {
+        const Entity* e = &records[i];
+        EngcRecord r = { e->position, e->size, e->type, { e->propertyValue, e->propertySubtype, e->propertySpeed } };
+        if (e->type == ENTITY_SNAKE) { ok = PushPiece(&pieces, -1, r); continue; }
+        if (e->type != ENTITY_WALL || e->size.x <= 0 || e->size.y <= 0) {
+            ok = PushPiece(&pieces, ClampChunk(e->position.y, chunkPixels, chunksY) * chunksX +
+                                    ClampChunk(e->position.x, chunkPixels, chunksX), r);
+            continue;
+        }
+
+        // Cut the wall along chunk edges; pieces hanging off the world stay
+        // with the border chunk
+        int cx0 = ClampChunk(e->position.x, chunkPixels, chunksX);
+        int cy0 = ClampChunk(e->position.y, chunkPixels, chunksY);
+        int cx1 = ClampChunk(e->position.x + e->size.x - 1, chunkPixels, chunksX);
+        int cy1 = ClampChunk(e->position.y + e->size.y - 1, chunkPixels, chunksY);
+        for (int cy = cy0; cy <= cy1 && ok; cy++) {
+            for (int cx = cx0; cx <= cx1 && ok; cx++) {
+                float x0 = cx == cx0 ? e->position.x : cx * chunkPixels;
+                float y0 = cy == cy0 ? e->position.y : cy * chunkPixels;
+                float x1 = cx == cx1 ? e->position.x + e->size.x : (cx + 1) * chunkPixels;
+                float y1 = cy == cy1 ? e->position.y + e->size.y : (cy + 1) * chunkPixels;
+                EngcRecord piece = r;
+                piece.position = (Vector2){ x0, y0 };
+                piece.size = (Vector2){ x1 - x0, y1 - y0 };
+                ok = PushPiece(&pieces, cy * chunksX + cx, piece);
+            }
+        }
+    }
+
+    EngcHeader h = {0};
+    memcpy(h.magic, ENGC_MAGIC, 4);
+    h.version = ENGC_VERSION;
+    h.chunkCells = (uint32_t)chunkCells;
+    h.chunksX = (uint32_t)chunksX;
+    h.chunksY = (uint32_t)chunksY;
+    h.chunkTableOffset = sizeof(EngcHeader);
+    h.recordsOffset = h.chunkTableOffset + (uint32_t)chunkCount * sizeof(EngcChunk);
+    h.recordCount = (uint32_t)pieces.count;
+    h.targetScore = meta.targetScore;
+    h.baseSpeed = meta.baseSpeed;
+    h.worldWidth = meta.worldSize.x;
+    h.worldHeight = meta.worldSize.y;
+    size_t end = h.recordsOffset + (size_t)pieces.count * sizeof(EngcRecord);
+    h.fileSize = (uint32_t)end;
+
+    unsigned char* image = ok ? (unsigned char*)ENGINE_MALLOC(end) : NULL;
+    if (!image) {
+        ENGINE_FREE(pieces.items);
+        EngineError("Could not save file to: %s", filename);
+        return false;
+    }
+    memset(image, 0, end);
+
+    // Count per chunk (globals in slot 0), prefix sum, then scatter
+    EngcChunk* chunks = (EngcChunk*)(image + h.chunkTableOffset);
+    EngcRecord* out = (EngcRecord*)(image + h.recordsOffset);
+    uint32_t* start = (uint32_t*)ENGINE_MALLOC(((size_t)chunkCount + 2) * sizeof(uint32_t));
+    if (!start) { ENGINE_FREE(image); ENGINE_FREE(pieces.items); return false; }
+    memset(start, 0, ((size_t)chunkCount + 2) * sizeof(uint32_t));
+    for (int i = 0; i < pieces.count; i++) start[pieces.items[i].chunk + 2]++;
+    for (int c = 0; c <= chunkCount; c++) start[c + 1] += start[c];
+    h.globalCount = start[1];
+    for (int c = 0; c < chunkCount; c++) {
+        chunks[c] = (EngcChunk){ start[c + 1], start[c + 2] - start[c + 1] };
+        if (chunks[c].count > h.maxChunkRecords) h.maxChunkRecords = chunks[c].count;
+    }
+    for (int i = 0; i < pieces.count; i++) out[start[pieces.items[i].chunk + 1]++] = pieces.items[i].record;
+    memcpy(image, &h, sizeof(h));
+    ENGINE_FREE(start);
+    ENGINE_FREE(pieces.items);
+
+    FILE* file = fopen(filename, "wb");
+    ok = file && fwrite(image, 1, end, file) == end;
+    if (file) ok = (fclose(file) == 0) && ok;
+    ENGINE_FREE(image);
+    if (!ok) EngineError("Could not save file to: %s", filename);
+    return ok;
+}
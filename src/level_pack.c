@@ -0,0 +1,536 @@
+#include "game_types.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// --- LEVEL PACK FORMAT (.engp) ---
+// Thousands of levels behind one open() and one mmap():
+//
+//   EngpHeader
+//   EngpEntry entries[entryCount]
+//   uint32_t  index[indexSize]       (name hash, open addressing, entry + 1)
+//   char      names[namesSize]       (NUL-terminated, referenced by entries)
+//   blobs                            (8-byte aligned, one per entry)
+//
+// A blob is the level file as it was packed (.eng text or .engb binary),
+// stored as is or LZ-compressed. Each entry keeps a hash of the raw bytes,
+// checked on every load. Lookups by name or index are O(1) and never touch
+// the directory.
+#define ENGP_MAGIC "ENGP"
+#define ENGP_VERSION 1
+#define PACK_STACK_BYTES (16 * 1024)
+
+enum { ENGP_TEXT = 0, ENGP_BINARY = 1 };
+enum { ENGP_STORED = 0, ENGP_LZ = 1 };
+
+typedef struct EngpHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t fileSize;
+    uint32_t entryCount;
+    uint32_t indexSize;         // Power of two
+    uint32_t entriesOffset;
+    uint32_t indexOffset;
+    uint32_t namesOffset;
+    uint32_t namesSize;
+} EngpHeader;
+
+typedef struct EngpEntry {
+    uint64_t dataOffset;
+    uint64_t hash;              // FNV-1a 64 of the raw (uncompressed) level
+    uint32_t nameOffset;
+    uint32_t storedSize;
+    uint32_t rawSize;
+    uint16_t format;
+    uint16_t compression;
+} EngpEntry;
+
+_Static_assert(sizeof(EngpEntry) == 32, "entry layout");
+
+static uint64_t HashBytes(const unsigned char* p, size_t n) {
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < n; i++) h = (h ^ p[i]) * 1099511628211ull;
+    return h;
+}
+
+// FNV-1a with a final avalanche, like the reload table
+static uint32_t HashName(const char* name) {
+    uint32_t h = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)name; *p; p++) h = (h ^ *p) * 16777619u;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    return h ^ (h >> 16);
+}
+
+// --- LZ ---
+// Byte-oriented LZ77 in the LZ4 style: a token holds the literal length
+// (high nibble) and match length - 4 (low nibble), 15 means more length
+// bytes follow. Matches reach back up to 64K. The last sequence is
+// literals only. Text levels repeat the same few shapes on every line and
+// shrink by 3-5x.
+#define LZ_MIN_MATCH 4
+#define LZ_HASH_BITS 12
+#define LZ_MAX_OFFSET 65535
+
+static bool PutByte(unsigned char* dst, size_t cap, size_t* op, unsigned char b) {
+    if (*op >= cap) return false;
+    dst[(*op)++] = b;
+    return true;
+}
+
+static bool PutLength(unsigned char* dst, size_t cap, size_t* op, size_t extra) {
+    for (; extra >= 255; extra -= 255) if (!PutByte(dst, cap, op, 255)) return false;
+    return PutByte(dst, cap, op, (unsigned char)extra);
+}
+
+static bool EmitSequence(unsigned char* dst, size_t cap, size_t* op, const unsigned char* literals,
+                         size_t literalLength, size_t offset, size_t matchLength) {
+    size_t lit = literalLength < 15 ? literalLength : 15;
+    size_t mat = matchLength ? (matchLength - LZ_MIN_MATCH < 15 ? matchLength - LZ_MIN_MATCH : 15) : 0;
+    if (!PutByte(dst, cap, op, (unsigned char)(lit << 4 | mat))) return false;
+    if (lit == 15 && !PutLength(dst, cap, op, literalLength - 15)) return false;
+    if (*op + literalLength > cap) return false;
+    memcpy(dst + *op, literals, literalLength);
+    *op += literalLength;
+    if (!matchLength) return true;
+
+    if (!PutByte(dst, cap, op, (unsigned char)(offset & 0xff)) || !PutByte(dst, cap, op, (unsigned char)(offset >> 8))) return false;
+    return mat < 15 || PutLength(dst, cap, op, matchLength - LZ_MIN_MATCH - 15);
+}
+
+// Returns the compressed size, or 0 if it wouldn't fit in cap
+static size_t LzCompress(const unsigned char* src, size_t n, unsigned char* dst, size_t cap) {
+    uint32_t table[1 << LZ_HASH_BITS];  // Position + 1 of the last 4 bytes with this hash, 0 = none
+    memset(table, 0, sizeof(table));
+
+    size_t ip = 0, anchor = 0, op = 0;
+    while (ip + LZ_MIN_MATCH <= n) {
+        uint32_t seq;
+        memcpy(&seq, src + ip, sizeof(seq));
+        uint32_t h = (seq * 2654435761u) >> (32 - LZ_HASH_BITS);
+        size_t candidate = table[h];
+        table[h] = (uint32_t)(ip + 1);
+        if (candidate == 0 || ip - (candidate - 1) > LZ_MAX_OFFSET || memcmp(src + candidate - 1, src + ip, LZ_MIN_MATCH) != 0) {
+            ip++;
+            continue;
+        }
+        candidate--;
+
+        size_t length = LZ_MIN_MATCH;
+        while (ip + length < n && src[candidate + length] == src[ip + length]) length++;
+        if (!EmitSequence(dst, cap, &op, src + anchor, ip - anchor, ip - candidate, length)) return 0;
+        ip += length;
+        anchor = ip;
+    }
+    if (!EmitSequence(dst, cap, &op, src + anchor, n - anchor, 0, 0)) return 0;
+    return op;
+}
+
+static bool GetLength(const unsigned char* src, size_t n, size_t* ip, size_t* length) {
+    unsigned char b;
+    do {
+        if (*ip >= n) return false;
+        b = src[(*ip)++];
+        *length += b;
+    } while (b == 255);
+    return true;
+}
+
+// Decodes exactly rawSize bytes; false on any malformed input
+static bool LzDecompress(const unsigned char* src, size_t n, unsigned char* dst, size_t rawSize) {
+    size_t ip = 0, op = 0;
+    while (ip < n) {
+        unsigned char token = src[ip++];
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !GetLength(src, n, &ip, &literalLength)) return false;
+        if (literalLength > n - ip || literalLength > rawSize - op) return false;
+        memcpy(dst + op, src + ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+        if (ip == n) break;
+
+        if (n - ip < 2) return false;
+        size_t offset = src[ip] | (size_t)src[ip + 1] << 8;
+        ip += 2;
+        size_t matchLength = (token & 15);
+        if (matchLength == 15 && !GetLength(src, n, &ip, &matchLength)) return false;
+        matchLength += LZ_MIN_MATCH;
+        if (offset == 0 || offset > op || matchLength > rawSize - op) return false;
+        for (size_t i = 0; i < matchLength; i++, op++) dst[op] = dst[op - offset];  // May overlap
+    }
+    return op == rawSize;
+}
+
+// --- READER ---
+static const EngpEntry* EntryAt(const LevelPack* pack, int index) {
+    return &((const EngpEntry*)pack->entries)[index];
+}
+
+// Maps and validates a pack; the per-level checks happen here once, so a
+// load only has to look at its own entry.
+static int64_t FileTimeNs(const struct stat* st) {
+    return (int64_t)st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+}
+
+bool OpenLevelPack(LevelPack* pack, const char* filename) {
+    *pack = (LevelPack){0};
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(EngpHeader)) { close(fd); return false; }
+    size_t size = (size_t)st.st_size;
+    void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+
+    const unsigned char* base = (const unsigned char*)data;
+    const EngpHeader* h = (const EngpHeader*)base;
+    uint64_t n = h->entryCount;
+    bool ok = memcmp(h->magic, ENGP_MAGIC, 4) == 0 && h->version == ENGP_VERSION && h->fileSize == size &&
+              h->indexSize > n && (h->indexSize & (h->indexSize - 1)) == 0 &&
+              (h->entriesOffset & 7) == 0 && h->entriesOffset >= sizeof(EngpHeader) &&
+              h->entriesOffset + n * sizeof(EngpEntry) <= size &&
+              (h->indexOffset & 3) == 0 && h->indexOffset + (uint64_t)h->indexSize * sizeof(uint32_t) <= size &&
+              h->namesOffset + (uint64_t)h->namesSize <= size &&
+              (n == 0 || (h->namesSize > 0 && base[h->namesOffset + h->namesSize - 1] == '\0'));
+
+    const EngpEntry* entries = (const EngpEntry*)(base + h->entriesOffset);
+    for (uint64_t i = 0; ok && i < n; i++) {
+        const EngpEntry* e = &entries[i];
+        ok = e->nameOffset < h->namesSize && (e->dataOffset & 7) == 0 &&
+             e->dataOffset <= size && e->storedSize <= size - e->dataOffset &&
+             e->format <= ENGP_BINARY && e->compression <= ENGP_LZ &&
+             (e->compression == ENGP_LZ || e->storedSize == e->rawSize);
+    }
+    // Entries are all in range and at least one slot is empty, so a probe ends
+    const uint32_t* index = (const uint32_t*)(base + h->indexOffset);
+    bool anyEmpty = false;
+    for (uint64_t i = 0; ok && i < h->indexSize; i++) {
+        ok = index[i] <= n;
+        anyEmpty |= index[i] == 0;
+    }
+    ok = ok && anyEmpty;
+
+    if (!ok) { munmap(data, size); return false; }
+    *pack = (LevelPack){ data, size, entries, index, h->indexSize - 1, (const char*)base + h->namesOffset, (int)n,
+                         (uint64_t)st.st_dev, (uint64_t)st.st_ino, FileTimeNs(&st) };
+    return true;
+}
+
+void CloseLevelPack(LevelPack* pack) {
+    if (pack->map) munmap(pack->map, pack->mapSize);
+    *pack = (LevelPack){0};
+}
+
+int FindPackedLevel(const LevelPack* pack, const char* name) {
+    if (pack->count == 0) return -1;
+    uint32_t slot = HashName(name) & pack->indexMask;
+    for (uint64_t probes = 0; probes <= pack->indexMask; probes++, slot = (slot + 1) & pack->indexMask) {
+        uint32_t entry = pack->index[slot];
+        if (entry == 0) return -1;
+        if (strcmp(pack->names + EntryAt(pack, (int)entry - 1)->nameOffset, name) == 0) return (int)entry - 1;
+    }
+    return -1;
+}
+
+const char* PackedLevelName(const LevelPack* pack, int index) {
+    return (index >= 0 && index < pack->count) ? pack->names + EntryAt(pack, index)->nameOffset : NULL;
+}
+
+// Fills a state that ResetLevel has just cleared, like the other in-memory
+// loaders. A blob whose hash doesn't match is rejected.
+bool LoadPackedLevel(GameState* state, const LevelPack* pack, int index) {
+    if (index < 0 || index >= pack->count) return false;
+    const EngpEntry* e = EntryAt(pack, index);
+    const char* name = pack->names + e->nameOffset;
+    const unsigned char* raw = (const unsigned char*)pack->map + e->dataOffset;
+
+    _Alignas(8) unsigned char small[PACK_STACK_BYTES];
+    unsigned char* buffer = NULL;
+    if (e->compression == ENGP_LZ) {
+        buffer = e->rawSize <= sizeof(small) ? small : (unsigned char*)ENGINE_MALLOC(e->rawSize ? e->rawSize : 1);
+        if (!buffer) return false;
+        if (!LzDecompress(raw, e->storedSize, buffer, e->rawSize)) {
+            if (buffer != small) ENGINE_FREE(buffer);
+            EngineError("Corrupt packed level %s", name);
+            return false;
+        }
+        raw = buffer;
+    }
+
+    bool ok = HashBytes(raw, e->rawSize) == e->hash;
+    if (!ok) EngineError("Corrupt packed level %s", name);
+    else if (e->format == ENGP_BINARY) {
+        ok = LoadLevelBinaryMemory(state, raw, e->rawSize);
+        if (!ok) EngineError("Invalid binary level %s", name);
+    } else {
+        LevelError error = {0};
+        ok = LoadLevelTextMemory(state, (const char*)raw, e->rawSize, &error);
+        if (!ok) PrintLevelError(name, error);
+    }
+    if (buffer && buffer != small) ENGINE_FREE(buffer);
+    return ok;
+}
+
+// --- PACK PATHS ---
+// Packs named in level paths stay open, so sampling levels from a pack costs
+// no open() after the first. A pack rewritten since it was mapped is mapped
+// again. The table is shared by the prefetch worker and the main thread, and
+// a load holds the lock so the mapping it reads can't be replaced under it.
+typedef struct OpenPack {
+    char path[LEVEL_PATH_MAX];
+    LevelPack pack;
+} OpenPack;
+
+static OpenPack openPacks[LEVEL_PACKS_OPEN];
+static int openPackCount;
+static pthread_mutex_t openPacksLock = PTHREAD_MUTEX_INITIALIZER;
+
+// "dir/levels.engp:name" or "dir/levels.engp:#index"
+bool IsPackedLevelPath(const char* path) {
+    return strstr(path, ".engp:") != NULL;
+}
+
+static bool PackUnchanged(const LevelPack* pack, const char* filename) {
+    struct stat st;
+    return stat(filename, &st) == 0 && (uint64_t)st.st_dev == pack->fileDevice && (uint64_t)st.st_ino == pack->fileInode &&
+           (size_t)st.st_size == pack->mapSize && FileTimeNs(&st) == pack->fileTime;
+}
+
+// Caller holds openPacksLock
+static void ForgetOpenPack(int i) {
+    CloseLevelPack(&openPacks[i].pack);
+    openPacks[i] = openPacks[--openPackCount];
+}
+
+static void ForgetOpenPackPath(const char* filename) {
+    pthread_mutex_lock(&openPacksLock);
+    for (int i = 0; i < openPackCount; i++) {
+        if (strcmp(openPacks[i].path, filename) == 0) { ForgetOpenPack(i); break; }
+    }
+    pthread_mutex_unlock(&openPacksLock);
+}
+
+bool LoadLevelFromPack(GameState* state, const char* path) {
+    const char* split = strstr(path, ".engp:");
+    if (!split) return false;
+    size_t packLength = (size_t)(split - path) + 5;
+    const char* name = split + 6;
+    if (packLength >= LEVEL_PATH_MAX) { EngineError("Failed to load %s", path); return false; }
+    char packPath[LEVEL_PATH_MAX];
+    memcpy(packPath, path, packLength);
+    packPath[packLength] = '\0';
+
+    LevelPack local = {0};
+    const LevelPack* pack = NULL;
+    pthread_mutex_lock(&openPacksLock);
+    for (int i = 0; i < openPackCount && !pack; i++) {
+        if (strcmp(openPacks[i].path, packPath) != 0) continue;
+        if (PackUnchanged(&openPacks[i].pack, packPath)) pack = &openPacks[i].pack;
+        else ForgetOpenPack(i);
+        break;
+    }
+    if (!pack) {
+        if (openPackCount < LEVEL_PACKS_OPEN && OpenLevelPack(&openPacks[openPackCount].pack, packPath)) {
+            strcpy(openPacks[openPackCount].path, packPath);
+            pack = &openPacks[openPackCount++].pack;
+        } else if (OpenLevelPack(&local, packPath)) {
+            pack = &local;  // Table full: this load only
+        }
+    }
+
+    int index = -1;
+    if (pack && name[0] == '#') {
+        char* end;
+        long n = strtol(name + 1, &end, 10);
+        if (*end == '\0' && end != name + 1 && n >= 0 && n < pack->count) index = (int)n;
+    } else if (pack) {
+        index = FindPackedLevel(pack, name);
+    }
+    bool ok = index >= 0 && LoadPackedLevel(state, pack, index);
+    pthread_mutex_unlock(&openPacksLock);
+
+    if (!pack) EngineError("Failed to load %s", path);
+    else if (index < 0) EngineError("No level %s in pack", path);
+    if (pack == &local) CloseLevelPack(&local);
+    return ok;
+}
+
+// Every level of a pack as a "pack:name" path, in pack order, for playlists.
+// One allocation; release it with ENGINE_FREE.
+char** ListPackedLevels(const char* filename, int* count) {
+    LevelPack pack;
+    if (!OpenLevelPack(&pack, filename)) { EngineError("Failed to load %s", filename); return NULL; }
+
+    size_t prefix = strlen(filename) + 1;
+    size_t bytes = (size_t)pack.count * sizeof(char*);
+    for (int i = 0; i < pack.count; i++) bytes += prefix + strlen(PackedLevelName(&pack, i)) + 1;
+    char** paths = (char**)ENGINE_MALLOC(bytes ? bytes : 1);
+    if (paths) {
+        char* out = (char*)(paths + pack.count);
+        for (int i = 0; i < pack.count; i++) {
+            paths[i] = out;
+            out += sprintf(out, "%s:%s", filename, PackedLevelName(&pack, i)) + 1;
+        }
+        *count = pack.count;
+    }
+    CloseLevelPack(&pack);
+    return paths;
+}
+
+void FreeLevelPacks(void) {
+    pthread_mutex_lock(&openPacksLock);
+    for (int i = 0; i < openPackCount; i++) CloseLevelPack(&openPacks[i].pack);
+    openPackCount = 0;
+    pthread_mutex_unlock(&openPacksLock);
+}
+
+// --- WRITER ---
+static unsigned char* ReadWholeFile(const char* path, size_t* size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    unsigned char* data = NULL;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long length = ftell(file);
+        if (length >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+            data = (unsigned char*)ENGINE_MALLOC((size_t)length + 1);
+            if (data && fread(data, 1, (size_t)length, file) != (size_t)length) { ENGINE_FREE(data); data = NULL; }
+            *size = (size_t)length;
+        }
+    }
+    fclose(file);
+    return data;
+}
+
+// Entry name: the file name without directory or extension
+static void LevelNameOf(const char* path, const char** name, size_t* length) {
+    const char* slash = strrchr(path, '/');
+    *name = slash ? slash + 1 : path;
+    const char* dot = strrchr(*name, '.');
+    *length = dot && dot != *name ? (size_t)(dot - *name) : strlen(*name);
+}
+
+static bool PadTo8(FILE* file, uint64_t* offset) {
+    static const unsigned char zeros[8] = {0};
+    size_t pad = (size_t)((8 - (*offset & 7)) & 7);
+    *offset += pad;
+    return pad == 0 || fwrite(zeros, 1, pad, file) == pad;
+}
+
+// Packs level files as they are (.eng or .engb; compile with levelc first to
+// merge walls). Names come from the file names and must be unique. With
+// compress set, each blob is LZ-compressed when that makes it smaller.
+bool SaveLevelPack(const char* filename, const char* const* paths, int count, bool compress) {
+    uint32_t indexSize = 16;
+    while (indexSize < (uint32_t)count * 2) indexSize *= 2;
+
+    EngpHeader h = {0};
+    memcpy(h.magic, ENGP_MAGIC, 4);
+    h.version = ENGP_VERSION;
+    h.entryCount = (uint32_t)count;
+    h.indexSize = indexSize;
+    h.entriesOffset = sizeof(EngpHeader);
+    h.indexOffset = h.entriesOffset + (uint32_t)count * sizeof(EngpEntry);
+    h.namesOffset = h.indexOffset + indexSize * sizeof(uint32_t);
+    for (int i = 0; i < count; i++) {
+        const char* name;
+        size_t length;
+        LevelNameOf(paths[i], &name, &length);
+        h.namesSize += (uint32_t)length + 1;
+    }
+
+    size_t entryBytes = (size_t)(count ? count : 1) * sizeof(EngpEntry);
+    EngpEntry* entries = (EngpEntry*)ENGINE_MALLOC(entryBytes);
+    uint32_t* index = (uint32_t*)ENGINE_MALLOC(indexSize * sizeof(uint32_t));
+    char* names = (char*)ENGINE_MALLOC(h.namesSize ? h.namesSize : 1);
+    ForgetOpenPackPath(filename);  // Truncating a mapped pack would fault its readers
+    FILE* file = fopen(filename, "wb");
+    bool ok = entries && index && names && file;
+    if (entries) memset(entries, 0, entryBytes);
+    if (index) memset(index, 0, indexSize * sizeof(uint32_t));
+
+    // Names and index first, so a duplicate fails before any blob is written
+    uint32_t nameOffset = 0;
+    for (int i = 0; ok && i < count; i++) {
+        const char* name;
+        size_t length;
+        LevelNameOf(paths[i], &name, &length);
+        memcpy(names + nameOffset, name, length);
+        names[nameOffset + length] = '\0';
+        entries[i].nameOffset = nameOffset;
+        nameOffset += (uint32_t)length + 1;
+
+        uint32_t slot = HashName(names + entries[i].nameOffset) & (indexSize - 1);
+        while (ok && index[slot]) {
+            if (strcmp(names + entries[index[slot] - 1].nameOffset, names + entries[i].nameOffset) == 0) {
+                EngineError("Duplicate level name %s in pack", names + entries[i].nameOffset);
+                ok = false;
+            }
+            slot = (slot + 1) & (indexSize - 1);
+        }
+        index[slot] = (uint32_t)i + 1;
+    }
+
+    // Blobs go after the tables; the tables are written last
+    uint64_t offset = h.namesOffset + h.namesSize;
+    ok = ok && fseek(file, (long)offset, SEEK_SET) == 0 && PadTo8(file, &offset);
+    for (int i = 0; ok && i < count; i++) {
+        EngpEntry* e = &entries[i];
+        if (HasExtension(paths[i], ".engc") || HasExtension(paths[i], ".engp")) {
+            EngineError("Can't pack %s: only .eng and .engb levels", paths[i]);
+            ok = false;
+            break;
+        }
+        size_t size = 0;
+        unsigned char* raw = ReadWholeFile(paths[i], &size);
+        if (!raw || size > UINT32_MAX) { EngineError("Failed to load %s", paths[i]); ENGINE_FREE(raw); ok = false; break; }
+
+        // Reject broken text levels now rather than when they're played
+        LevelError error = {0};
+        LevelMeta meta = {0};
+        e->format = HasExtension(paths[i], ".engb") ? ENGP_BINARY : ENGP_TEXT;
+        if (e->format == ENGP_TEXT && !ParseLevelText((const char*)raw, size, &meta, NULL, NULL, &error)) {
+            PrintLevelError(paths[i], error);
+            ENGINE_FREE(raw);
+            ok = false;
+            break;
+        }
+
+        unsigned char* packed = compress ? (unsigned char*)ENGINE_MALLOC(size ? size : 1) : NULL;
+        size_t packedSize = packed ? LzCompress(raw, size, packed, size) : 0;
+        const unsigned char* blob = packedSize ? packed : raw;
+        e->compression = packedSize ? ENGP_LZ : ENGP_STORED;
+        e->storedSize = (uint32_t)(packedSize ? packedSize : size);
+        e->rawSize = (uint32_t)size;
+        e->hash = HashBytes(raw, size);
+        e->dataOffset = offset;
+        ok = fwrite(blob, 1, e->storedSize, file) == e->storedSize;
+        offset += e->storedSize;
+        ok = ok && PadTo8(file, &offset);
+        ENGINE_FREE(packed);
+        ENGINE_FREE(raw);
+    }
+
+    h.fileSize = offset;
+    if (ok) {
+        ok = fseek(file, 0, SEEK_SET) == 0 &&
+             fwrite(&h, sizeof(h), 1, file) == 1 &&
+             fwrite(entries, sizeof(EngpEntry), count, file) == (size_t)count &&
+             fwrite(index, sizeof(uint32_t), indexSize, file) == indexSize &&
+             fwrite(names, 1, h.namesSize, file) == h.namesSize;
+    }
+    if (file) ok = (fclose(file) == 0) && ok;
+    ENGINE_FREE(entries);
+    ENGINE_FREE(index);
+    ENGINE_FREE(names);
+    if (!ok) {
+        EngineError("Could not save file to: %s", filename);
+        if (file) remove(filename);
+    }
+    return ok;
+}
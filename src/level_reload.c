@@ -0,0 +1,227 @@
+#include "game_types.h"
+#include <string.h>
+
+// --- HOT RELOAD ---
+// A reload parses the file again and diffs it against the records the level
+// was built from:
+//   1. A new record identical to an old one keeps that entity untouched.
+//   2. A leftover new record takes over the next leftover old record of the
+//      same type, in file order, and updates its entity in place (a move or
+//      an edit).
+//   3. Old records still left are destroyed, new ones are spawned.
+// Work is linear in the record count and scratch memory is reused, so a
+// reload costs about as much as parsing the file once.
+
+#define RELOAD_RESERVE 64
+
+static bool ReserveRecords(LevelReloader* r, int needed) {
+    if (needed <= r->capacity) return true;
+    int capacity = r->capacity ? r->capacity : RELOAD_RESERVE;
+    while (capacity < needed) capacity *= 2;
+
+    Entity* records = (Entity*)ENGINE_REALLOC(r->records, capacity * sizeof(Entity));
+    if (!records) return false;
+    r->records = records;
+    EntityHandle* handles = (EntityHandle*)ENGINE_REALLOC(r->handles, capacity * sizeof(EntityHandle));
+    if (!handles) return false;
+    r->handles = handles;
+    r->capacity = capacity;
+    return true;
+}
+
+static bool ReserveIncoming(LevelReloader* r, int needed) {
+    if (needed <= r->incomingCapacity) return true;
+    int capacity = r->incomingCapacity ? r->incomingCapacity : RELOAD_RESERVE;
+    while (capacity < needed) capacity *= 2;
+
+    Entity* incoming = (Entity*)ENGINE_REALLOC(r->incoming, capacity * sizeof(Entity));
+    if (!incoming) return false;
+    r->incoming = incoming;
+    EntityHandle* handles = (EntityHandle*)ENGINE_REALLOC(r->incomingHandles, capacity * sizeof(EntityHandle));
+    if (!handles) return false;
+    r->incomingHandles = handles;
+    r->incomingCapacity = capacity;
+    return true;
+}
+
+static bool SameRecord(const Entity* a, const Entity* b) {
+    return a->type == b->type &&
+           a->position.x == b->position.x && a->position.y == b->position.y &&
+           a->size.x == b->size.x && a->size.y == b->size.y &&
+           a->propertyValue == b->propertyValue && a->propertySubtype == b->propertySubtype &&
+           a->propertySpeed == b->propertySpeed;
+}
+
+static uint32_t HashFloat(uint32_t h, float f) {
+    f += 0.0f; // -0 and 0 compare equal, so they must hash equal
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return (h ^ bits) * 16777619u;
+}
+
+// FNV-1a over the fields SameRecord compares, then a final avalanche: grid
+// coordinates are floats with all-zero low bits, and FNV alone would leave
+// the table index (the low bits) the same for every record.
+static uint32_t HashRecord(const Entity* e) {
+    uint32_t h = 2166136261u;
+    h = (h ^ (uint32_t)e->type) * 16777619u;
+    h = HashFloat(h, e->position.x);
+    h = HashFloat(h, e->position.y);
+    h = HashFloat(h, e->size.x);
+    h = HashFloat(h, e->size.y);
+    h = (h ^ (uint32_t)e->propertyValue) * 16777619u;
+    h = (h ^ (uint32_t)e->propertySubtype) * 16777619u;
+    h = HashFloat(h, e->propertySpeed);
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    return h ^ (h >> 16);
+}
+
+// Power-of-two table at most half full; the per-record arrays share its size
+static bool ReserveTable(LevelReloader* r, int count) {
+    int size = r->tableSize ? r->tableSize : RELOAD_RESERVE;
+    while (size < count * 2) size *= 2;
+    if (size != r->tableSize) {
+        int* table = (int*)ENGINE_REALLOC(r->table, size * sizeof(int));
+        if (!table) return false;
+        r->table = table;
+        int* heads = (int*)ENGINE_REALLOC(r->heads, size * sizeof(int));
+        if (!heads) return false;
+        r->heads = heads;
+        int* next = (int*)ENGINE_REALLOC(r->next, size * sizeof(int));
+        if (!next) return false;
+        r->next = next;
+        bool* matched = (bool*)ENGINE_REALLOC(r->matched, size * sizeof(bool));
+        if (!matched) return false;
+        r->matched = matched;
+        r->tableSize = size;
+    }
+    memset(r->table, 0xff, r->tableSize * sizeof(int));
+    memset(r->matched, 0, r->tableSize * sizeof(bool));
+    return true;
+}
+
+// Slot holding records with the same key as e, or the empty slot it would take
+static int FindSlot(const LevelReloader* r, const Entity* records, const Entity* e) {
+    int mask = r->tableSize - 1;
+    int slot = (int)(HashRecord(e) & mask);
+    while (r->table[slot] >= 0 && !SameRecord(&records[r->table[slot]], e)) slot = (slot + 1) & mask;
+    return slot;
+}
+
+static void CollectRecord(void* user, const Entity* def) {
+    LevelReloader* r = (LevelReloader*)user;
+    if (!ReserveIncoming(r, r->incomingCount + 1)) return;
+    r->incoming[r->incomingCount++] = *def;
+}
+
+// Call right after a full load, while alive[] is still in record order
+void TrackLoadedLevel(LevelReloader* r, const GameState* state) {
+    r->count = 0;
+    if (!ReserveRecords(r, state->aliveCount)) return;
+    for (int k = 0; k < state->aliveCount; k++) {
+        int id = state->alive[k];
+        r->records[k] = EntityRecordOf(state, id);
+        r->handles[k] = HandleOf(state, id);
+    }
+    r->count = state->aliveCount;
+}
+
+// Text levels only. On a parse error the error is printed and the live level
+// is left exactly as it was. META lines that were deleted fall back to their
+// defaults, as in a full load.
+bool ApplyLevelChanges(LevelReloader* r, GameState* state, const char* filename, LevelDiff* diff) {
+    LevelMeta meta = DefaultLevelMeta();
+    LevelError error = {0};
+    r->incomingCount = 0;
+    if (!ParseLevelFile(filename, &meta, CollectRecord, r, &error)) {
+        PrintLevelError(filename, error);
+        return false;
+    }
+    if (!ReserveTable(r, r->count)) return false;
+
+    // Index old records by content. Duplicates chain in file order, so
+    // matching the n-th copy of a line is O(1) however many there are.
+    LevelDiff d = {0};
+    for (int i = r->count - 1; i >= 0; i--) {
+        int slot = FindSlot(r, r->records, &r->records[i]);
+        if (r->table[slot] < 0) { r->table[slot] = i; r->heads[slot] = -1; }
+        r->next[i] = r->heads[slot];
+        r->heads[slot] = i;
+    }
+
+    // 1. Identical records keep their entity, dead or alive
+    for (int j = 0; j < r->incomingCount; j++) {
+        r->incomingHandles[j] = NULL_HANDLE;
+        int slot = FindSlot(r, r->records, &r->incoming[j]);
+        int i = r->table[slot] >= 0 ? r->heads[slot] : -1;
+        if (i < 0) continue;
+        r->heads[slot] = r->next[i];
+        r->matched[i] = true;
+        r->incomingHandles[j] = r->handles[i];
+        d.unchanged++;
+    }
+
+    // 2. Pair the rest by type and order, updating in place. An edited line
+    //    whose entity is gone (an eaten pickup) comes back as a new entity.
+    int cursor[ENTITY_COIN + 1] = {0};
+    for (int j = 0; j < r->incomingCount; j++) {
+        if (r->incomingHandles[j].index >= 0) continue;
+        EntityType type = r->incoming[j].type;
+        int i = cursor[type];
+        while (i < r->count && (r->matched[i] || r->records[i].type != type)) i++;
+        cursor[type] = i;
+        if (i >= r->count) continue;
+
+        r->matched[i] = true;
+        if (IsAlive(state, r->handles[i])) {
+            UpdateLevelEntity(state, r->handles[i], &r->incoming[j]);
+            r->incomingHandles[j] = r->handles[i];
+            d.changed++;
+        }
+    }
+
+    // 3. Destroy before spawning so a full world can still take the new lines
+    for (int i = 0; i < r->count; i++) {
+        if (r->matched[i]) continue;
+        DestroyEntity(state, r->handles[i]);
+        d.removed++;
+    }
+    for (int j = 0; j < r->incomingCount; j++) {
+        if (r->incomingHandles[j].index >= 0) continue;
+        r->incomingHandles[j] = SpawnLevelEntity(state, &r->incoming[j], true);
+        d.added++;
+    }
+
+    ApplyLevelMeta(state, meta);
+
+    // The new file becomes the baseline for the next reload
+    Entity* records = r->records;
+    EntityHandle* handles = r->handles;
+    int capacity = r->capacity;
+    r->records = r->incoming;
+    r->handles = r->incomingHandles;
+    r->capacity = r->incomingCapacity;
+    r->count = r->incomingCount;
+    r->incoming = records;
+    r->incomingHandles = handles;
+    r->incomingCapacity = capacity;
+    r->incomingCount = 0;
+
+    if (diff) *diff = d;
+    return true;
+}
+
+void FreeLevelReloader(LevelReloader* r) {
+    ENGINE_FREE(r->records);
+    ENGINE_FREE(r->handles);
+    ENGINE_FREE(r->incoming);
+    ENGINE_FREE(r->incomingHandles);
+    ENGINE_FREE(r->table);
+    ENGINE_FREE(r->heads);
+    ENGINE_FREE(r->next);
+    ENGINE_FREE(r->matched);
+    *r = (LevelReloader){0};
+}
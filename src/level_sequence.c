@@ -0,0 +1,203 @@
+#include "game_types.h"
+#include <string.h>
+
+// --- LEVEL SEQUENCE ---
+// Two GameStates: active is played on the owner's thread, spare belongs to the
+// worker while it builds the next level. Advancing swaps the pointers, so the
+// switch costs nothing once the prefetch has finished. Parsed levels also go
+// into an LRU cache, which makes restarts and revisits skip the disk.
+
+// Builds pendingIndex into spare: from a copy of the cached records when
+// possible, otherwise from disk. Either way the build runs with the lock
+// released, so the main thread never waits on it.
+static void* PrefetchWorker(void* arg) {
+    LevelSequence* seq = (LevelSequence*)arg;
+    LevelImage copy = {0};
+    pthread_mutex_lock(&seq->lock);
+    while (!seq->quit) {
+        if (seq->pendingIndex < 0) { pthread_cond_wait(&seq->wake, &seq->lock); continue; }
+
+        int index = seq->pendingIndex;
+        const char* path = seq->paths[index];
+        seq->working = true;
+        bool cached = CopyCachedLevel(&seq->cache, path, &copy);
+        pthread_mutex_unlock(&seq->lock);
+        bool ok = true;
+        if (cached) InstantiateLevelImage(&copy, seq->spare);
+        else ok = LoadLevel(seq->spare, path);
+        pthread_mutex_lock(&seq->lock);
+        if (ok && !cached && !seq->spare->stream) CaptureLevel(&seq->cache, path, seq->spare);
+        seq->working = false;
+
+        // The request may have changed while we were loading; if so, go again
+        if (seq->pendingIndex == index) {
+            seq->pendingIndex = -1;
+            seq->readyIndex = index;
+            seq->readyOk = ok;
+        }
+        pthread_cond_broadcast(&seq->done);
+    }
+    pthread_mutex_unlock(&seq->lock);
+    ENGINE_FREE(copy.entities);
+    return NULL;
+}
+
+// Call with the lock held
+static void RequestPrefetch(LevelSequence* seq, int index) {
+    if (index >= seq->count || seq->readyIndex == index || seq->pendingIndex == index) return;
+    seq->pendingIndex = index;
+    seq->readyIndex = -1;
+    pthread_cond_signal(&seq->wake);
+}
+
+// Synchronous load into active, through the cache. Streamed levels hold only
+// their resident chunks and are never cached.
+static bool LoadActive(LevelSequence* seq, int index) {
+    const char* path = seq->paths[index];
+    pthread_mutex_lock(&seq->lock);
+    bool ok = InstantiateCachedLevel(&seq->cache, path, seq->active);
+    pthread_mutex_unlock(&seq->lock);
+
+    if (!ok) {
+        ok = LoadLevel(seq->active, path);
+        if (ok && !seq->active->stream) {
+            pthread_mutex_lock(&seq->lock);
+            CaptureLevel(&seq->cache, path, seq->active);
+            pthread_mutex_unlock(&seq->lock);
+        }
+    }
+    TrackLoadedLevel(&seq->reload, seq->active);
+    return ok;
+}
+
+static GameState* NewGameState(void) {
+    GameState* state = (GameState*)ENGINE_MALLOC(sizeof(GameState));
+    if (state) memset(state, 0, sizeof(GameState));
+    return state;
+}
+
+// Loads the first level and starts prefetching the second. paths must stay
+// valid until FreeLevelSequence. Fails if the first level doesn't load.
+bool InitLevelSequence(LevelSequence* seq, const char* const* paths, int count) {
+    *seq = (LevelSequence){ .paths = paths, .count = count, .pendingIndex = -1, .readyIndex = -1 };
+    if (count <= 0) return false;
+
+    seq->active = NewGameState();
+    seq->spare = NewGameState();
+    if (!seq->active || !seq->spare) {
+        ENGINE_FREE(seq->active);
+        ENGINE_FREE(seq->spare);
+        return false;
+    }
+
+    pthread_mutex_init(&seq->lock, NULL);
+    pthread_cond_init(&seq->wake, NULL);
+    pthread_cond_init(&seq->done, NULL);
+    if (pthread_create(&seq->worker, NULL, PrefetchWorker, seq) != 0) {
+        pthread_mutex_destroy(&seq->lock);
+        pthread_cond_destroy(&seq->wake);
+        pthread_cond_destroy(&seq->done);
+        ENGINE_FREE(seq->active);
+        ENGINE_FREE(seq->spare);
+        return false;
+    }
+
+    if (!LoadActive(seq, 0)) {
+        FreeLevelSequence(seq);
+        return false;
+    }
+    seq->active->currentLevel = 1;
+
+    pthread_mutex_lock(&seq->lock);
+    RequestPrefetch(seq, 1);
+    pthread_mutex_unlock(&seq->lock);
+    return true;
+}
+
+// Swaps in the next level, carrying the score over. Blocks only if the
+// prefetch hasn't finished yet. Levels that fail to load are skipped; returns
+// false when no level after the current one loads.
+bool AdvanceLevel(LevelSequence* seq) {
+    int next = seq->current + 1;
+    pthread_mutex_lock(&seq->lock);
+    for (;; next++) {
+        if (next >= seq->count) { pthread_mutex_unlock(&seq->lock); return false; }
+        RequestPrefetch(seq, next);
+        while (seq->readyIndex != next) pthread_cond_wait(&seq->done, &seq->lock);
+        if (seq->readyOk) break;
+        EngineLog("Skipping level %s", seq->paths[next]);
+        seq->readyIndex = -1;
+    }
+
+    GameState* finished = seq->active;
+    seq->active = seq->spare;
+    seq->spare = finished;
+    seq->readyIndex = -1;
+    seq->current = next;
+
+    seq->active->score = finished->score;
+    seq->active->levelStartScore = finished->score;
+    seq->active->currentLevel = next + 1;
+    seq->active->bruteForceCollisions = finished->bruteForceCollisions;
+    TrackLoadedLevel(&seq->reload, seq->active);
+
+    RequestPrefetch(seq, next + 1);
+    pthread_mutex_unlock(&seq->lock);
+    return true;
+}
+
+// Back to the first level with a zero score (ENTER after game over). If the
+// first level no longer loads, the game stays over and the score stands.
+bool RestartLevelSequence(LevelSequence* seq) {
+    if (!LoadActive(seq, 0)) {
+        seq->active->gameOver = true;
+        return false;
+    }
+    seq->current = 0;
+    seq->active->score = 0;
+    seq->active->levelStartScore = 0;
+    seq->active->currentLevel = 1;
+
+    pthread_mutex_lock(&seq->lock);
+    RequestPrefetch(seq, 1);
+    pthread_mutex_unlock(&seq->lock);
+    return true;
+}
+
+// Rereads the current level from disk (F5 or a file watch). Text levels are
+// diffed into the running level, so the snake and score survive; binary and
+// chunked levels are compiled output and reload in full. A level that fails to parse
+// keeps running as it was.
+void ReloadCurrentLevel(LevelSequence* seq) {
+    const char* path = seq->paths[seq->current];
+    pthread_mutex_lock(&seq->lock);
+    InvalidateCachedLevel(&seq->cache, path);
+    pthread_mutex_unlock(&seq->lock);
+
+    if (!HasExtension(path, ".eng")) { LoadActive(seq, seq->current); return; }
+
+    LevelDiff diff;
+    if (ApplyLevelChanges(&seq->reload, seq->active, path, &diff)) {
+        EngineLog("Level Reloaded. %d unchanged, %d changed, %d added, %d removed",
+                  diff.unchanged, diff.changed, diff.added, diff.removed);
+    }
+}
+
+void FreeLevelSequence(LevelSequence* seq) {
+    pthread_mutex_lock(&seq->lock);
+    seq->quit = true;
+    pthread_cond_signal(&seq->wake);
+    pthread_mutex_unlock(&seq->lock);
+    pthread_join(seq->worker, NULL);
+
+    pthread_mutex_destroy(&seq->lock);
+    pthread_cond_destroy(&seq->wake);
+    pthread_cond_destroy(&seq->done);
+    FreeLevelCache(&seq->cache);
+    FreeLevelReloader(&seq->reload);
+    UnloadGameState(seq->active);
+    UnloadGameState(seq->spare);
+    ENGINE_FREE(seq->active);
+    ENGINE_FREE(seq->spare);
+    seq->active = seq->spare = NULL;
+}
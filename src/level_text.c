@@ -0,0 +1,329 @@
+#include "game_types.h"
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// --- TEXT LEVEL FORMAT (.eng) ---
+// One record per line, fields separated by spaces or tabs:
+//
+//   # comment
+//   META TARGET <int>
+//   META SPEED <float>
+//   META WORLD <w> <h>        (world size in pixels; the screen by default)
+//   <type> x y [w h [value [subtype [speed]]]]
+//
+// type is one of P A W E C. Omitted fields default to one cell (w, h),
+// value 10, subtype 1, speed 0. The parser is a single pass over the whole
+// buffer: no copies, no allocation, no per-line libc calls.
+
+EntityType EntityTypeFromChar(char c) {
+    switch (c) {
+        case 'P': return ENTITY_SNAKE;
+        case 'A': return ENTITY_APPLE;
+        case 'W': return ENTITY_WALL;
+        case 'E': return ENTITY_ENEMY_BASIC;
+        case 'C': return ENTITY_COIN;
+        default:  return ENTITY_NONE;
+    }
+}
+
+char EntityTypeChar(EntityType type) {
+    switch (type) {
+        case ENTITY_SNAKE:       return 'P';
+        case ENTITY_APPLE:       return 'A';
+        case ENTITY_WALL:        return 'W';
+        case ENTITY_ENEMY_BASIC: return 'E';
+        case ENTITY_COIN:        return 'C';
+        default:                 return '?';
+    }
+}
+
+// --- TOKENIZER ---
+typedef struct TextCursor {
+    const char* p;
+    const char* end;
+    const char* lineStart;
+    int line;
+} TextCursor;
+
+static bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+static bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+static void SkipBlanks(TextCursor* c) {
+    while (c->p < c->end && IsBlank(*c->p)) c->p++;
+}
+
+static bool AtLineEnd(const TextCursor* c) {
+    return c->p >= c->end || *c->p == '\n' || *c->p == '#';
+}
+
+// A token ends at a blank, a newline, a comment or the end of the buffer
+static bool AtTokenEnd(const TextCursor* c) {
+    return AtLineEnd(c) || IsBlank(*c->p);
+}
+
+static bool Fail(const TextCursor* c, LevelError* error, const char* message) {
+    if (error) *error = (LevelError){ c->line, (int)(c->p - c->lineStart) + 1, message };
+    return false;
+}
+
+// Matches a keyword followed by a token boundary
+static bool MatchWord(TextCursor* c, const char* word, size_t length) {
+    if ((size_t)(c->end - c->p) < length || memcmp(c->p, word, length) != 0) return false;
+    const char* save = c->p;
+    c->p += length;
+    if (AtTokenEnd(c)) return true;
+    c->p = save;
+    return false;
+}
+
+static bool ReadInt(TextCursor* c, int* out, LevelError* error) {
+    const char* p = c->p;
+    bool negative = false;
+    if (p < c->end && (*p == '-' || *p == '+')) negative = (*p++ == '-');
+    if (p >= c->end || !IsDigit(*p)) return Fail(c, error, "expected an integer");
+
+    // INT_MIN has no positive counterpart, so a minus sign allows one more
+    long long limit = negative ? -(long long)INT_MIN : INT_MAX;
+    long long v = 0;
+    while (p < c->end && IsDigit(*p)) {
+        v = v * 10 + (*p++ - '0');
+        if (v > limit) return Fail(c, error, "integer out of range");
+    }
+    c->p = p;
+    if (!AtTokenEnd(c)) return Fail(c, error, "unexpected character in integer");
+    *out = (int)(negative ? -v : v);
+    return true;
+}
+
+// Decimal with an optional exponent: [-]digits[.digits][e[-]digits]
+static bool ReadFloat(TextCursor* c, float* out, LevelError* error) {
+    const char* p = c->p;
+    bool negative = false;
+    if (p < c->end && (*p == '-' || *p == '+')) negative = (*p++ == '-');
+
+    double v = 0.0;
+    int digits = 0;
+    while (p < c->end && IsDigit(*p)) { v = v * 10.0 + (*p++ - '0'); digits++; }
+    if (p < c->end && *p == '.') {
+        p++;
+        double scale = 0.1;
+        while (p < c->end && IsDigit(*p)) { v += (*p++ - '0') * scale; scale *= 0.1; digits++; }
+    }
+    if (digits == 0) return Fail(c, error, "expected a number");
+
+    if (p < c->end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negativeExp = false;
+        if (p < c->end && (*p == '-' || *p == '+')) negativeExp = (*p++ == '-');
+        if (p >= c->end || !IsDigit(*p)) return Fail(c, error, "expected an exponent");
+        int exp = 0;
+        while (p < c->end && IsDigit(*p)) { if (exp < 100) exp = exp * 10 + (*p - '0'); p++; }
+        for (int i = 0; i < exp; i++) v = negativeExp ? v * 0.1 : v * 10.0;
+    }
+
+    c->p = p;
+    if (!AtTokenEnd(c)) return Fail(c, error, "unexpected character in number");
+    *out = (float)(negative ? -v : v);
+    return true;
+}
+
+static bool ParseMeta(TextCursor* c, LevelMeta* meta, LevelError* error) {
+    SkipBlanks(c);
+    if (MatchWord(c, "TARGET", 6)) { SkipBlanks(c); return ReadInt(c, &meta->targetScore, error); }
+    if (MatchWord(c, "SPEED", 5))  { SkipBlanks(c); return ReadFloat(c, &meta->baseSpeed, error); }
+    if (MatchWord(c, "WORLD", 5)) {
+        int w, h;
+        SkipBlanks(c);
+        if (!ReadInt(c, &w, error)) return false;
+        SkipBlanks(c);
+        if (!ReadInt(c, &h, error)) return false;
+        if (w < CELL_SIZE || h < CELL_SIZE) return Fail(c, error, "world must be at least one cell");
+        meta->worldSize = (Vector2){ (float)w, (float)h };
+        return true;
+    }
+    return Fail(c, error, "unknown META key (expected TARGET, SPEED or WORLD)");
+}
+
+static bool ParseEntity(TextCursor* c, Entity* def, LevelError* error) {
+    EntityType type = EntityTypeFromChar(*c->p);
+    if (type == ENTITY_NONE) return Fail(c, error, "unknown entity type (expected P, A, W, E or C)");
+    c->p++;
+    if (!AtTokenEnd(c)) return Fail(c, error, "entity type must be a single character");
+
+    int x, y, w = CELL_SIZE, h = CELL_SIZE, val = 10, sub = 1;
+    float spd = 0.0f;
+    int* ints[] = { &x, &y, &w, &h, &val, &sub };
+
+    // x and y are required, the rest are optional in order
+    for (int i = 0; i < 6; i++) {
+        SkipBlanks(c);
+        if (AtLineEnd(c)) {
+            if (i < 2) return Fail(c, error, "expected x and y");
+            break;
+        }
+        if (!ReadInt(c, ints[i], error)) return false;
+    }
+    SkipBlanks(c);
+    if (!AtLineEnd(c) && !ReadFloat(c, &spd, error)) return false;
+
+    *def = (Entity){ true, type, {(float)x, (float)y}, {(float)w, (float)h}, val, sub, spd };
+    return true;
+}
+
+// --- PARSER ---
+// Parses a whole .eng buffer, calling onEntity for every entity line and
+// updating meta for META lines. Stops at the first malformed line and fills
+// error; entities before it have already been delivered.
+bool ParseLevelText(const char* text, size_t length, LevelMeta* meta, LevelEntityFn onEntity, void* user, LevelError* error) {
+    TextCursor c = { text, text + length, text, 1 };
+
+    while (c.p < c.end) {
+        SkipBlanks(&c);
+        if (!AtLineEnd(&c)) {
+            if (MatchWord(&c, "META", 4)) {
+                if (!ParseMeta(&c, meta, error)) return false;
+            } else {
+                Entity def;
+                if (!ParseEntity(&c, &def, error)) return false;
+                if (onEntity) onEntity(user, &def);
+            }
+            SkipBlanks(&c);
+            if (!AtLineEnd(&c)) return Fail(&c, error, "unexpected trailing field");
+        }
+
+        // Skip the rest of the line (a comment, if any) and the newline
+        const char* nl = memchr(c.p, '\n', (size_t)(c.end - c.p));
+        if (!nl) break;
+        c.p = nl + 1;
+        c.lineStart = c.p;
+        c.line++;
+    }
+    return true;
+}
+
+// --- LOADER ---
+#define LEVEL_TEXT_STACK_BYTES (16 * 1024)
+
+static void SpawnParsedEntity(void* user, const Entity* def) {
+    SpawnLevelEntity((GameState*)user, def, true);
+}
+
+// Fills a state that ResetLevel has just cleared. On a parse error the state
+// is reset again, so a bad file never leaves half a level behind.
+bool LoadLevelTextMemory(GameState* state, const char* text, size_t length, LevelError* error) {
+    LevelMeta meta = LevelMetaOf(state);
+    if (!ParseLevelText(text, length, &meta, SpawnParsedEntity, state, error)) {
+        ResetLevel(state);
+        return false;
+    }
+    ApplyLevelMeta(state, meta);
+    return true;
+}
+
+// Parses a .eng file from disk. I/O failures are reported with line 0.
+bool ParseLevelFile(const char* filename, LevelMeta* meta, LevelEntityFn onEntity, void* user, LevelError* error) {
+    LevelError ioError = { 0, 0, "cannot read file" };
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) { if (error) *error = ioError; return false; }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) { close(fd); if (error) *error = ioError; return false; }
+
+    // Hand-made levels fit on the stack; mapping them costs more than reading.
+    // Anything bigger is mapped. An empty file is an empty level.
+    char small[LEVEL_TEXT_STACK_BYTES];
+    size_t size = st.st_size > 0 ? (size_t)st.st_size : 0;
+    const char* text = small;
+    void* data = NULL;
+    if (size > sizeof(small)) {
+        data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) { close(fd); if (error) *error = ioError; return false; }
+        text = (const char*)data;
+    } else if (size > 0 && read(fd, small, size) != (ssize_t)size) {
+        close(fd); if (error) *error = ioError; return false;
+    }
+    close(fd);
+
+    bool ok = ParseLevelText(text, size, meta, onEntity, user, error);
+    if (data) munmap(data, size);
+    return ok;
+}
+
+void PrintLevelError(const char* filename, LevelError error) {
+    if (error.line == 0) EngineError("Failed to load %s", filename);
+    else EngineError("%s:%d:%d: %s", filename, error.line, error.column, error.message);
+}
+
+bool LoadLevelText(GameState* state, const char* filename) {
+    LevelMeta meta = LevelMetaOf(state);
+    LevelError error = {0};
+    if (!ParseLevelFile(filename, &meta, SpawnParsedEntity, state, &error)) {
+        ResetLevel(state);
+        PrintLevelError(filename, error);
+        return false;
+    }
+    ApplyLevelMeta(state, meta);
+    return true;
+}
+
+// --- WRITER ---
+// Trailing fields that match the loader's defaults are left out, so
+// hand-made levels stay readable.
+static void WriteLevelMeta(FILE* file, LevelMeta meta) {
+    fprintf(file, "META TARGET %d\nMETA SPEED %g\n", meta.targetScore, meta.baseSpeed);
+    if (meta.worldSize.x != SCREEN_W || meta.worldSize.y != SCREEN_H) {
+        fprintf(file, "META WORLD %d %d\n", (int)meta.worldSize.x, (int)meta.worldSize.y);
+    }
+}
+
+static void WriteLevelRecord(FILE* file, const Entity* e) {
+    int fields = 2;
+    if (e->propertySpeed != 0.0f) fields = 7;
+    else if (e->propertySubtype != 1) fields = 6;
+    else if (e->propertyValue != 10) fields = 5;
+    else if (e->size.x != CELL_SIZE || e->size.y != CELL_SIZE) fields = 4;
+
+    fprintf(file, "%c %d %d", EntityTypeChar(e->type), (int)e->position.x, (int)e->position.y);
+    if (fields >= 4) fprintf(file, " %d %d", (int)e->size.x, (int)e->size.y);
+    if (fields >= 5) fprintf(file, " %d", e->propertyValue);
+    if (fields >= 6) fprintf(file, " %d", e->propertySubtype);
+    if (fields >= 7) fprintf(file, " %g", e->propertySpeed);
+    fputc('\n', file);
+}
+
+static bool FinishLevelFile(FILE* file, const char* filename) {
+    bool ok = !ferror(file);
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) EngineError("Could not save file to: %s", filename);
+    return ok;
+}
+
+// Writes every live entity in alive[] order
+bool SaveLevelText(const GameState* state, const char* filename) {
+    FILE* file = fopen(filename, "w");
+    if (!file) { EngineError("Could not save file to: %s", filename); return false; }
+
+    WriteLevelMeta(file, LevelMetaOf(state));
+    for (int k = 0; k < state->aliveCount; k++) {
+        Entity e = EntityRecordOf(state, state->alive[k]);
+        WriteLevelRecord(file, &e);
+    }
+    return FinishLevelFile(file, filename);
+}
+
+// Writes the active records of an authoring array (the editor's), which
+// may hold more than MAX_ENTITIES
+bool SaveLevelRecords(const Entity* records, int count, LevelMeta meta, const char* filename) {
+    FILE* file = fopen(filename, "w");
+    if (!file) { EngineError("Could not save file to: %s", filename); return false; }
+
+    WriteLevelMeta(file, meta);
+    for (int i = 0; i < count; i++) {
+        if (records[i].active) WriteLevelRecord(file, &records[i]);
+    }
+    return FinishLevelFile(file, filename);
+}
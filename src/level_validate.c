@@ -0,0 +1,246 @@
+#include "game_types.h"
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+// --- LEVEL VALIDATION ---
+// The snake moves one cell at a time from its spawn, so its head can only be
+// on the spawn's lattice: spawn + (i, j) * CELL_SIZE, inside the world. A
+// lattice cell is blocked if the head there would overlap a wall. A BFS from
+// the spawn gives the reachable cells, and a pickup is reachable if the head
+// overlaps it from one of them. Enemies move and the body can be steered, so
+// neither blocks: passing is necessary for a level to be solvable, not proof.
+
+typedef struct Validator {
+    GameState* scratch;         // Only .engb and packed levels load into it
+    Entity* records;
+    int count;
+    int capacity;
+    uint8_t* cells;             // Per lattice cell: CELL_WALL / CELL_SEEN bits
+    int* queue;
+    int cellCapacity;
+} Validator;
+
+#define CELL_WALL 1
+#define CELL_SEEN 2
+
+typedef struct Lattice {
+    float originX, originY;     // Lattice offset inside a cell
+    int cols, rows;
+    Vector2 head;               // Head size
+} Lattice;
+
+static void CollectLevelRecord(void* user, const Entity* def) {
+    Validator* v = (Validator*)user;
+    if (v->count == v->capacity) {
+        int capacity = v->capacity ? v->capacity * 2 : 256;
+        Entity* records = (Entity*)ENGINE_REALLOC(v->records, (size_t)capacity * sizeof(Entity));
+        if (!records) return;
+        v->records = records;
+        v->capacity = capacity;
+    }
+    v->records[v->count++] = *def;
+}
+
+// Lattice cells [*i0, *i1] where a head would overlap [start, start + size)
+// on one axis. Empty when *i0 > *i1.
+static void LatticeSpan(float origin, float head, int count, float start, float size, int* i0, int* i1) {
+    *i0 = (int)floorf((start - head - origin) / CELL_SIZE) + 1;
+    *i1 = (int)ceilf((start + size - origin) / CELL_SIZE) - 1;
+    if (*i0 < 0) *i0 = 0;
+    if (*i1 > count - 1) *i1 = count - 1;
+}
+
+static bool ReserveCells(Validator* v, int cells) {
+    if (cells <= v->cellCapacity) return true;
+    uint8_t* grid = (uint8_t*)ENGINE_REALLOC(v->cells, (size_t)cells);
+    if (!grid) return false;
+    v->cells = grid;
+    int* queue = (int*)ENGINE_REALLOC(v->queue, (size_t)cells * sizeof(int));
+    if (!queue) return false;
+    v->queue = queue;
+    v->cellCapacity = cells;
+    return true;
+}
+
+static LevelProblem CheckLevel(Validator* v, const char* path, LevelReport* r) {
+    v->count = 0;
+    LevelMeta meta;
+    if (!ReadLevelRecords(path, v->scratch, &meta, CollectLevelRecord, v)) return LEVEL_LOAD_FAILED;
+    r->targetScore = meta.targetScore;
+
+    // Points on offer, and the player's spawn (the first snake)
+    const Entity* snake = NULL;
+    for (int k = 0; k < v->count; k++) {
+        const Entity* e = &v->records[k];
+        if (e->type == ENTITY_SNAKE && !snake) snake = e;
+        if (e->type == ENTITY_APPLE || e->type == ENTITY_COIN) { r->pickups++; r->totalPoints += e->propertyValue; }
+    }
+    if (!snake) return LEVEL_NO_SNAKE;
+
+    Lattice l;
+    l.head = snake->size;
+    l.originX = fmodf(snake->position.x, CELL_SIZE);
+    l.originY = fmodf(snake->position.y, CELL_SIZE);
+    if (l.originX < 0) l.originX += CELL_SIZE;
+    if (l.originY < 0) l.originY += CELL_SIZE;
+    l.cols = (int)floorf((meta.worldSize.x - CELL_SIZE - l.originX) / CELL_SIZE) + 1;
+    l.rows = (int)floorf((meta.worldSize.y - CELL_SIZE - l.originY) / CELL_SIZE) + 1;
+    int sx = (int)lroundf((snake->position.x - l.originX) / CELL_SIZE);
+    int sy = (int)lroundf((snake->position.y - l.originY) / CELL_SIZE);
+    if (l.cols <= 0 || l.rows <= 0 || sx < 0 || sy < 0 || sx >= l.cols || sy >= l.rows) return LEVEL_SPAWN_BLOCKED;
+    if (!ReserveCells(v, l.cols * l.rows)) return LEVEL_LOAD_FAILED;
+
+    // Rasterise the walls onto the lattice
+    memset(v->cells, 0, (size_t)l.cols * l.rows);
+    for (int k = 0; k < v->count; k++) {
+        const Entity* e = &v->records[k];
+        if (e->type != ENTITY_WALL) continue;
+        int x0, x1, y0, y1;
+        LatticeSpan(l.originX, l.head.x, l.cols, e->position.x, e->size.x, &x0, &x1);
+        LatticeSpan(l.originY, l.head.y, l.rows, e->position.y, e->size.y, &y0, &y1);
+        for (int y = y0; y <= y1; y++) {
+            if (x0 <= x1) memset(&v->cells[y * l.cols + x0], CELL_WALL, (size_t)(x1 - x0 + 1));
+        }
+    }
+    int spawn = sy * l.cols + sx;
+    if (v->cells[spawn] & CELL_WALL) return LEVEL_SPAWN_BLOCKED;
+
+    // 4-connected flood fill from the spawn
+    int head = 0, tail = 0;
+    v->cells[spawn] |= CELL_SEEN;
+    v->queue[tail++] = spawn;
+    while (head < tail) {
+        int c = v->queue[head++];
+        int x = c % l.cols, y = c / l.cols;
+        int next[4] = { x > 0 ? c - 1 : -1, x < l.cols - 1 ? c + 1 : -1,
+                        y > 0 ? c - l.cols : -1, y < l.rows - 1 ? c + l.cols : -1 };
+        for (int i = 0; i < 4; i++) {
+            if (next[i] < 0 || v->cells[next[i]]) continue;
+            v->cells[next[i]] = CELL_SEEN;
+            v->queue[tail++] = next[i];
+        }
+    }
+    r->reachableCells = tail;
+
+    for (int k = 0; k < v->count; k++) {
+        const Entity* e = &v->records[k];
+        if (e->type != ENTITY_APPLE && e->type != ENTITY_COIN) continue;
+        int x0, x1, y0, y1;
+        LatticeSpan(l.originX, l.head.x, l.cols, e->position.x, e->size.x, &x0, &x1);
+        LatticeSpan(l.originY, l.head.y, l.rows, e->position.y, e->size.y, &y0, &y1);
+        bool reached = false;
+        for (int y = y0; y <= y1 && !reached; y++) {
+            for (int x = x0; x <= x1 && !reached; x++) reached = (v->cells[y * l.cols + x] & CELL_SEEN) != 0;
+        }
+        if (reached) { r->reachablePickups++; r->reachablePoints += e->propertyValue; }
+    }
+    return r->reachablePoints < r->targetScore ? LEVEL_TARGET_UNREACHABLE : LEVEL_OK;
+}
+
+static void ValidateOne(Validator* v, const char* path, LevelReport* r) {
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    *r = (LevelReport){ .path = path };
+    r->problem = CheckLevel(v, path, r);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    r->seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+}
+
+// --- WORK QUEUE ---
+// Workers take the next unclaimed level until none are left, so slow levels
+// don't hold up a whole slice. Each worker reuses its own scratch.
+typedef struct ValidationQueue {
+    const char* const* paths;
+    LevelReport* reports;
+    int count;
+    int next;
+    pthread_mutex_t lock;
+} ValidationQueue;
+
+static void* ValidationWorker(void* arg) {
+    ValidationQueue* q = (ValidationQueue*)arg;
+    Validator v = {0};
+    v.scratch = (GameState*)ENGINE_MALLOC(sizeof(GameState));
+    if (v.scratch) memset(v.scratch, 0, sizeof(GameState));
+
+    for (;;) {
+        pthread_mutex_lock(&q->lock);
+        int i = q->next++;
+        pthread_mutex_unlock(&q->lock);
+        if (i >= q->count) break;
+        if (v.scratch) ValidateOne(&v, q->paths[i], &q->reports[i]);
+        else q->reports[i] = (LevelReport){ .path = q->paths[i], .problem = LEVEL_LOAD_FAILED };
+    }
+
+    if (v.scratch) UnloadGameState(v.scratch);
+    ENGINE_FREE(v.scratch);
+    ENGINE_FREE(v.records);
+    ENGINE_FREE(v.cells);
+    ENGINE_FREE(v.queue);
+    return NULL;
+}
+
+// Fills reports[i] for paths[i]. threads <= 0 uses every online core.
+void ValidateLevels(const char* const* paths, int count, int threads, LevelReport* reports) {
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads > count) threads = count;
+    if (threads < 1) threads = 1;
+
+    ValidationQueue q = { .paths = paths, .reports = reports, .count = count };
+    pthread_mutex_init(&q.lock, NULL);
+    pthread_t* workers = (pthread_t*)ENGINE_MALLOC((size_t)threads * sizeof(pthread_t));
+    int started = 0;
+    for (int t = 1; workers && t < threads; t++) {
+        if (pthread_create(&workers[started], NULL, ValidationWorker, &q) == 0) started++;
+    }
+    ValidationWorker(&q);  // The caller is a worker too
+    for (int t = 0; t < started; t++) pthread_join(workers[t], NULL);
+    ENGINE_FREE(workers);
+    pthread_mutex_destroy(&q.lock);
+}
+
+const char* LevelProblemName(LevelProblem problem) {
+    switch (problem) {
+        case LEVEL_OK:                 return "ok";
+        case LEVEL_LOAD_FAILED:        return "load_failed";
+        case LEVEL_NO_SNAKE:           return "no_snake";
+        case LEVEL_SPAWN_BLOCKED:      return "spawn_blocked";
+        case LEVEL_TARGET_UNREACHABLE: return "target_unreachable";
+        default:                       return "unknown";
+    }
+}
+
+// --- REPORT ---
+static void PrintJsonString(FILE* out, const char* s) {
+    fputc('"', out);
+    for (const unsigned char* p = (const unsigned char*)s; *p; p++) {
+        if (*p == '"' || *p == '\\') fprintf(out, "\\%c", *p);
+        else if (*p < 0x20) fprintf(out, "\\u%04x", *p);
+        else fputc(*p, out);
+    }
+    fputc('"', out);
+}
+
+// One JSON document: a record per level, then totals per problem. Without
+// timing the output only depends on the levels, not on the run.
+void PrintLevelReports(FILE* out, const LevelReport* reports, int count, bool timing) {
+    int problems[LEVEL_TARGET_UNREACHABLE + 1] = {0};
+    fprintf(out, "{\n  \"levels\": [");
+    for (int i = 0; i < count; i++) {
+        const LevelReport* r = &reports[i];
+        problems[r->problem]++;
+        fprintf(out, "%s\n    {\"path\": ", i ? "," : "");
+        PrintJsonString(out, r->path);
+        fprintf(out, ", \"valid\": %s, \"problem\": \"%s\", \"target\": %d, \"pickups\": %d, \"reachable_pickups\": %d, "
+                     "\"points\": %d, \"reachable_points\": %d, \"reachable_cells\": %d",
+                r->problem == LEVEL_OK ? "true" : "false", LevelProblemName(r->problem), r->targetScore,
+                r->pickups, r->reachablePickups, r->totalPoints, r->reachablePoints, r->reachableCells);
+        if (timing) fprintf(out, ", \"ms\": %.3f", r->seconds * 1e3);
+        fputc('}', out);
+    }
+    fprintf(out, "\n  ],\n  \"summary\": {\"levels\": %d", count);
+    for (int p = 0; p <= LEVEL_TARGET_UNREACHABLE; p++) fprintf(out, ", \"%s\": %d", LevelProblemName((LevelProblem)p), problems[p]);
+    fprintf(out, "}\n}\n");
+}
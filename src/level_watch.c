@@ -0,0 +1,69 @@
+#include "game_types.h"
+#include <string.h>
+
+// --- LEVEL WATCHER ---
+// Watches the directory rather than the file: editors that save through a
+// temp file and rename() replace the inode, which would end a file watch.
+// Polling is non-blocking and drains every queued event, so a burst of writes
+// from one save turns into a single reload.
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/inotify.h>
+
+void InitLevelWatcher(LevelWatcher* w) {
+    *w = (LevelWatcher){ .fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC), .wd = -1 };
+}
+
+bool WatchLevelFile(LevelWatcher* w, const char* path) {
+    if (w->fd < 0) return false;
+
+    const char* slash = strrchr(path, '/');
+    const char* name = slash ? slash + 1 : path;
+    char dir[LEVEL_PATH_MAX];
+    size_t dirLength = slash ? (size_t)(slash - path) : 1;
+    if (dirLength >= sizeof(dir) || strlen(name) >= sizeof(w->name)) return false;
+    if (slash) {
+        memcpy(dir, path, dirLength);
+        dir[dirLength] = '\0';
+        if (dirLength == 0) strcpy(dir, "/");
+    } else {
+        strcpy(dir, ".");
+    }
+
+    // Watching the same directory again returns the same descriptor
+    int wd = inotify_add_watch(w->fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd < 0) return false;
+    if (w->wd >= 0 && w->wd != wd) inotify_rm_watch(w->fd, w->wd);
+    w->wd = wd;
+    strcpy(w->name, name);
+    return true;
+}
+
+bool LevelFileChanged(LevelWatcher* w) {
+    if (w->fd < 0 || w->wd < 0) return false;
+
+    bool changed = false;
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t n;
+    while ((n = read(w->fd, buffer, sizeof(buffer))) > 0) {
+        for (char* p = buffer; p < buffer + n; ) {
+            const struct inotify_event* ev = (const struct inotify_event*)p;
+            if (ev->wd == w->wd && ev->len > 0 && strcmp(ev->name, w->name) == 0) changed = true;
+            p += sizeof(struct inotify_event) + ev->len;
+        }
+    }
+    return changed;
+}
+
+void FreeLevelWatcher(LevelWatcher* w) {
+    if (w->fd >= 0) close(w->fd);
+    *w = (LevelWatcher){ .fd = -1, .wd = -1 };
+}
+
+#else
+// No watcher on this platform; F5 still reloads by hand
+void InitLevelWatcher(LevelWatcher* w) { *w = (LevelWatcher){ .fd = -1, .wd = -1 }; }
+bool WatchLevelFile(LevelWatcher* w, const char* path) { (void)w; (void)path; return false; }
+bool LevelFileChanged(LevelWatcher* w) { (void)w; return false; }
+void FreeLevelWatcher(LevelWatcher* w) { (void)w; }
+#endif
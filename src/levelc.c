@@ -0,0 +1,245 @@
+#include "game_types.h"
+#include <string.h>
+#include <math.h>
+
+// Level compiler: reads a level's records, merges its walls into a small set
+// of grid-aligned rectangles and writes the result as .eng text, as .engb
+// binary with the wall occupancy grid baked in, or as .engc chunks for
+// streaming. Text and chunked input are read record by record, so a level
+// may hold more than MAX_ENTITIES as long as it's compiled to .engc.
+//
+//   levelc [--no-merge] [--chunk cells] -o out.engb level.eng
+//   levelc [--no-lz] -o levels.engp level.eng level2.engb ...
+//
+// The second form packs level files as they are into one .engp archive.
+// Walls snap outward to whole cells, the same cells the occupancy grid
+// already marks for them, so a cell-sized snake collides exactly as before.
+
+typedef struct CellRect {
+    int x, y, w, h;
+} CellRect;
+
+typedef struct RecordList {
+    Entity* items;
+    int count;
+    int capacity;
+    bool failed;    // Out of memory: later records were dropped
+} RecordList;
+
+static void CollectRecord(void* user, const Entity* def) {
+    RecordList* list = (RecordList*)user;
+    if (list->failed) return;
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 256;
+        Entity* items = (Entity*)ENGINE_REALLOC(list->items, (size_t)capacity * sizeof(Entity));
+        if (!items) { list->failed = true; return; }
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = *def;
+}
+
+static bool IsMergeableWall(const Entity* e) {
+    return e->type == ENTITY_WALL && e->size.x > 0 && e->size.y > 0;
+}
+
+// Wall cells over the walls' bounding box (not clipped to the screen grid)
+typedef struct WallMask {
+    int x0, y0;
+    int cols, rows;
+    unsigned char* cells;
+    unsigned char* used;
+} WallMask;
+
+static void SnapRect(Vector2 pos, Vector2 size, int* x0, int* y0, int* x1, int* y1) {
+    *x0 = (int)floorf(pos.x / CELL_SIZE);
+    *y0 = (int)floorf(pos.y / CELL_SIZE);
+    *x1 = (int)ceilf((pos.x + size.x) / CELL_SIZE);  // Exclusive
+    *y1 = (int)ceilf((pos.y + size.y) / CELL_SIZE);
+}
+
+static bool BuildWallMask(const RecordList* records, WallMask* m) {
+    *m = (WallMask){0};
+    bool any = false;
+    int bx0 = 0, by0 = 0, bx1 = 0, by1 = 0;
+    for (int k = 0; k < records->count; k++) {
+        const Entity* e = &records->items[k];
+        if (!IsMergeableWall(e)) continue;
+        int x0, y0, x1, y1;
+        SnapRect(e->position, e->size, &x0, &y0, &x1, &y1);
+        if (!any) { bx0 = x0; by0 = y0; bx1 = x1; by1 = y1; any = true; }
+        if (x0 < bx0) bx0 = x0;
+        if (y0 < by0) by0 = y0;
+        if (x1 > bx1) bx1 = x1;
+        if (y1 > by1) by1 = y1;
+    }
+    if (!any) return true;
+
+    m->x0 = bx0;
+    m->y0 = by0;
+    m->cols = bx1 - bx0;
+    m->rows = by1 - by0;
+    size_t cells = (size_t)m->cols * m->rows;
+    m->cells = (unsigned char*)ENGINE_MALLOC(cells);
+    m->used = (unsigned char*)ENGINE_MALLOC(cells);
+    if (!m->cells || !m->used) return false;
+    memset(m->cells, 0, cells);
+
+    for (int k = 0; k < records->count; k++) {
+        const Entity* e = &records->items[k];
+        if (!IsMergeableWall(e)) continue;
+        int x0, y0, x1, y1;
+        SnapRect(e->position, e->size, &x0, &y0, &x1, &y1);
+        for (int y = y0; y < y1; y++) {
+            memset(&m->cells[(size_t)(y - m->y0) * m->cols + (x0 - m->x0)], 1, (size_t)(x1 - x0));
+        }
+    }
+    return true;
+}
+
+// Wall cell not yet covered. (a, b) is (row, column), or (column, row) when
+// scanning column-major.
+static bool FreeCell(const WallMask* m, bool columnMajor, int a, int b) {
+    size_t i = columnMajor ? (size_t)b * m->cols + a : (size_t)a * m->cols + b;
+    return m->cells[i] && !m->used[i];
+}
+
+// Greedy cover: from the first free cell in scan order, grow a run along the
+// scan line, then grow that run across while every cell under it is free.
+// Rectangles never overlap, so each wall cell keeps an occupancy count of 1.
+static int GreedyCover(WallMask* m, bool columnMajor, CellRect* out) {
+    memset(m->used, 0, (size_t)m->cols * m->rows);
+    int outer = columnMajor ? m->cols : m->rows;
+    int inner = columnMajor ? m->rows : m->cols;
+    int n = 0;
+
+    for (int a = 0; a < outer; a++) {
+        for (int b = 0; b < inner; b++) {
+            if (!FreeCell(m, columnMajor, a, b)) continue;
+
+            int length = 1;
+            while (b + length < inner && FreeCell(m, columnMajor, a, b + length)) length++;
+            int depth = 1;
+            for (bool grow = true; grow && a + depth < outer; ) {
+                for (int k = 0; k < length && grow; k++) grow = FreeCell(m, columnMajor, a + depth, b + k);
+                if (grow) depth++;
+            }
+
+            for (int d = 0; d < depth; d++) {
+                for (int k = 0; k < length; k++) {
+                    size_t i = columnMajor ? (size_t)(b + k) * m->cols + (a + d) : (size_t)(a + d) * m->cols + (b + k);
+                    m->used[i] = 1;
+                }
+            }
+            out[n++] = columnMajor ? (CellRect){ a, b, depth, length } : (CellRect){ b, a, length, depth };
+        }
+    }
+    return n;
+}
+
+int main(int argc, char** argv) {
+    const char* input = NULL;
+    const char* output = NULL;
+    bool merge = true;
+    bool compress = true;
+    int chunkCells = 16;
+    const char** inputs = (const char**)ENGINE_MALLOC((size_t)argc * sizeof(char*));
+    int inputCount = 0;
+    if (!inputs) return 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) output = argv[++i];
+        else if (strcmp(argv[i], "--no-merge") == 0) merge = false;
+        else if (strcmp(argv[i], "--no-lz") == 0) compress = false;
+        else if (strcmp(argv[i], "--chunk") == 0 && i + 1 < argc) chunkCells = atoi(argv[++i]);
+        else input = inputs[inputCount++] = argv[i];
+    }
+    if (output && HasExtension(output, ".engp") && inputCount > 0) {
+        bool ok = SaveLevelPack(output, inputs, inputCount, compress);
+        if (ok) printf("%d levels -> %s\n", inputCount, output);
+        ENGINE_FREE(inputs);
+        return ok ? 0 : 1;
+    }
+    ENGINE_FREE(inputs);
+    if (output && inputCount > 1) {
+        fprintf(stderr, "levelc: %d input levels; only a .engp output takes more than one\n", inputCount);
+        return 2;
+    }
+    if (!input || !output || chunkCells <= 0) {
+        fprintf(stderr, "usage: %s [--no-merge] [--chunk cells] -o out.eng|out.engb|out.engc level\n"
+                        "       %s [--no-lz] -o out.engp level...\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    GameState* state = (GameState*)ENGINE_MALLOC(sizeof(GameState));
+    if (!state) { fprintf(stderr, "levelc: out of memory\n"); return 1; }
+    memset(state, 0, sizeof(GameState));
+    LevelMeta meta;
+    RecordList src = {0};
+    if (!ReadLevelRecords(input, state, &meta, CollectRecord, &src)) return 1;
+    if (src.failed) { fprintf(stderr, "levelc: out of memory\n"); return 1; }
+
+    // Everything but the walls is copied over in order
+    RecordList dst = {0};
+    int wallsBefore = 0;
+    for (int k = 0; k < src.count; k++) {
+        const Entity* e = &src.items[k];
+        wallsBefore += e->type == ENTITY_WALL;
+        if (!merge || e->type != ENTITY_WALL) CollectRecord(&dst, e);
+    }
+
+    int wallsAfter = merge ? 0 : wallsBefore;
+    if (merge) {
+        WallMask mask;
+        if (!BuildWallMask(&src, &mask)) { fprintf(stderr, "levelc: out of memory\n"); return 1; }
+
+        // Try both scan orders and keep the smaller cover
+        size_t cells = (size_t)mask.cols * mask.rows;
+        CellRect* rows = (CellRect*)ENGINE_MALLOC((cells ? cells : 1) * sizeof(CellRect));
+        CellRect* cols = (CellRect*)ENGINE_MALLOC((cells ? cells : 1) * sizeof(CellRect));
+        if (!rows || !cols) { fprintf(stderr, "levelc: out of memory\n"); return 1; }
+        int rowCount = cells ? GreedyCover(&mask, false, rows) : 0;
+        int colCount = cells ? GreedyCover(&mask, true, cols) : 0;
+        CellRect* best = (colCount < rowCount) ? cols : rows;
+        int merged = (colCount < rowCount) ? colCount : rowCount;
+
+        for (int i = 0; i < merged; i++) {
+            CellRect r = best[i];
+            Entity wall = { true, ENTITY_WALL,
+                            { (float)((mask.x0 + r.x) * CELL_SIZE), (float)((mask.y0 + r.y) * CELL_SIZE) },
+                            { (float)(r.w * CELL_SIZE), (float)(r.h * CELL_SIZE) }, 10, 1, 0.0f };
+            CollectRecord(&dst, &wall);
+        }
+        wallsAfter = merged;
+        ENGINE_FREE(rows);
+        ENGINE_FREE(cols);
+        ENGINE_FREE(mask.cells);
+        ENGINE_FREE(mask.used);
+    }
+
+    // Chunked output takes any number of records; the others must fit a GameState
+    bool ok;
+    if (dst.failed) {
+        fprintf(stderr, "levelc: out of memory\n");
+        ok = false;
+    } else if (HasExtension(output, ".engc")) {
+        ok = SaveLevelChunked(dst.items, dst.count, meta, output, chunkCells);
+    } else if (dst.count > MAX_ENTITIES) {
+        fprintf(stderr, "levelc: %d entities don't fit in one level (max %d); write .engc instead\n", dst.count, MAX_ENTITIES);
+        ok = false;
+    } else {
+        ResetLevel(state);
+        ApplyLevelMeta(state, meta);
+        for (int k = 0; k < dst.count; k++) SpawnLevelEntity(state, &dst.items[k], true);
+        ok = HasExtension(output, ".engb") ? SaveLevelBinary(state, output, true) : SaveLevelText(state, output);
+    }
+    if (ok) {
+        printf("%s -> %s: entities %d -> %d, walls %d -> %d\n",
+               input, output, src.count, dst.count, wallsBefore, wallsAfter);
+    }
+
+    ENGINE_FREE(src.items);
+    ENGINE_FREE(dst.items);
+    UnloadGameState(state);
+    ENGINE_FREE(state);
+    return ok ? 0 : 1;
+}
@@ -1,121 +1,119 @@
 #include "raylib.h"
 #include "game_types.h"
-#include "engine.c" 
+#include "render.h"
+#include <math.h>
 
-void DrawCyberGrid() {
-    for (int i = 0; i < SCREEN_W; i += CELL_SIZE) {
-        DrawLine(i, 0, i, SCREEN_H, Fade(DARKGREEN, 0.2f));
-    }
-    for (int i = 0; i < SCREEN_H; i += CELL_SIZE) {
-        DrawLine(0, i, SCREEN_W, i, Fade(DARKGREEN, 0.2f));
-    }
+// --- CAMERA ---
+// Follows the first snake's head. On an axis where the world is bigger than
+// the screen the view is clamped inside the world; otherwise it stays at 0.
+static float FollowAxis(float centre, float screen, float world) {
+    float t = centre - screen / 2;
+    if (t > world - screen) t = world - screen;
+    if (t < 0) t = 0;
+    return t;
+}
+
+Camera2D FollowCamera(const RenderSnapshot* snap, Camera2D camera) {
+    if (snap->snakeCount == 0 || snap->snakes[0].count == 0) return camera;
+    Vector2 head = snap->segments[snap->snakes[0].first];
+    Vector2 size = snap->snakes[0].size;
+    camera.target.x = FollowAxis(head.x + size.x / 2, SCREEN_W, snap->worldSize.x);
+    camera.target.y = FollowAxis(head.y + size.y / 2, SCREEN_H, snap->worldSize.y);
+    return camera;
+}
+
+static void PushTurn(Simulation* sim, Vector2 turn) {
+    PushSimCommand(&sim->commands, (SimCommand){ SIM_TURN, turn });
+}
+
+// Level loads and reloads show up on the console, as they always have
+static void PrintEngineLog(const char* message) {
+    puts(message);
 }
 
-int main() {
+static const char* defaultLevels[] = { "assets/level1.eng", "assets/level2.eng", "assets/level3.eng" };
+
+// Usage: game [level...]   (defaults to the bundled levels, in order)
+//        game levels.engp   (every level in the pack, in pack order)
+int main(int argc, char** argv) {
+    SetEngineLog(PrintEngineLog);
+    const char* const* levels = defaultLevels;
+    int levelCount = sizeof(defaultLevels) / sizeof(defaultLevels[0]);
+    char** packed = NULL;
+    if (argc == 2 && HasExtension(argv[1], ".engp")) {
+        packed = ListPackedLevels(argv[1], &levelCount);
+        if (!packed) return 1;
+        levels = (const char* const*)packed;
+    } else if (argc > 1) {
+        levels = (const char* const*)(argv + 1);
+        levelCount = argc - 1;
+    }
+
     InitWindow(SCREEN_W, SCREEN_H, "Snake Engine Pro");
     SetTargetFPS(60);
 
-    GameState state;
-    state.score = 0;
-    state.currentLevel = 1;
-    
-    // Default load
-    LoadLevel(&state, "assets/level1.eng");
+    // Loads the first level and starts ticking on its own thread; the next
+    // level is prefetched in the background. raylib stays on this thread.
+    static Simulation sim;
+    if (!StartSimulation(&sim, levels, levelCount)) { CloseWindow(); return 1; }
+
+    // Cyber grid, one cell larger than the screen so it can be snapped under
+    // any view. While a level that fits the screen is played, its walls are
+    // baked in too.
+    BackgroundLayer background = {0};
+    GridStyle cyberGrid = { SCREEN_W + CELL_SIZE, SCREEN_H + CELL_SIZE, CELL_SIZE, BLACK, Fade(DARKGREEN, 0.2f) };
+    Camera2D camera = { {0, 0}, {0, 0}, 0.0f, 1.0f };  // target is the view's top-left corner
+
+    // Pickups, enemies and snakes: one batch per kind, drawn together
+    EntityRenderer entities;
+    InitEntityRenderer(&entities);
 
     while (!WindowShouldClose()) {
-        // --- HOT RELOAD ---
-        if (IsKeyPressed(KEY_F5)) {
-            LoadLevel(&state, "assets/level1.eng");
-        }
+        // Newest finished tick; frames and ticks no longer run in lockstep
+        const RenderSnapshot* snap = LatestSnapshot(&sim);
 
-        if (!state.gameOver) {
-            // --- UPDATE LOOP ---
-            
-            // 1. Snake Input & Move
-            for(int i=0; i<state.entityCount; i++) {
-                Entity* e = &state.entities[i];
-                if (!e->active) continue;
-
-                if(e->type == ENTITY_SNAKE) {
-                    SnakeData* s = (SnakeData*)e->data;
-                    if (IsKeyPressed(KEY_UP) && s->direction.y == 0) s->direction = (Vector2){0, -1};
-                    if (IsKeyPressed(KEY_DOWN) && s->direction.y == 0) s->direction = (Vector2){0, 1};
-                    if (IsKeyPressed(KEY_LEFT) && s->direction.x == 0) s->direction = (Vector2){-1, 0};
-                    if (IsKeyPressed(KEY_RIGHT) && s->direction.x == 0) s->direction = (Vector2){1, 0};
-                    
-                    s->moveTimer += GetFrameTime();
-                    
-                    // USE LEVEL SPEED
-                    if (s->moveTimer >= state.levelBaseSpeed) {
-                        MoveSnake(s);
-                        e->position = s->body[0]; 
-                        s->moveTimer = 0.0f;
-                    }
-                }
-                
-                // 2. Enemy Move (Basic)
-                else if (e->type == ENTITY_ENEMY_BASIC) {
-                    EnemyData* en = (EnemyData*)e->data;
-                    en->moveTimer += GetFrameTime();
-                    // Simple patrol logic could go here
-                    // e->position.x += en->direction.x * en->speed;
-                }
-            }
-
-            ResolveCollisions(&state); 
-            ProcessEvents(&state);     
-            CheckLevelProgression(&state);
-        }
-        else {
-            if (IsKeyPressed(KEY_ENTER)) {
-                state.score = 0;
-                LoadLevel(&state, "assets/level1.eng");
-            }
+        // --- INPUT ---
+        // Sent to the simulation, which applies the latest turn on its next step
+        if (IsKeyPressed(KEY_F5)) PushSimCommand(&sim.commands, (SimCommand){ SIM_RELOAD, {0, 0} });
+        if (!snap->gameOver) {
+            if (IsKeyPressed(KEY_UP)) PushTurn(&sim, (Vector2){0, -1});
+            if (IsKeyPressed(KEY_DOWN)) PushTurn(&sim, (Vector2){0, 1});
+            if (IsKeyPressed(KEY_LEFT)) PushTurn(&sim, (Vector2){-1, 0});
+            if (IsKeyPressed(KEY_RIGHT)) PushTurn(&sim, (Vector2){1, 0});
+        } else if (IsKeyPressed(KEY_ENTER)) {
+            PushSimCommand(&sim.commands, (SimCommand){ SIM_RESTART, {0, 0} });
         }
 
         // --- RENDER ---
+        camera = FollowCamera(snap, camera);
+        Rectangle view = { camera.target.x, camera.target.y, SCREEN_W, SCREEN_H };
+        bool bakeWalls = snap->worldSize.x <= SCREEN_W && snap->worldSize.y <= SCREEN_H;
+        UpdateBackground(&background, cyberGrid, (snap->gameOver || !bakeWalls) ? NULL : snap);
+
         BeginDrawing();
-        ClearBackground(BLACK);
-        DrawCyberGrid();
+        BeginMode2D(camera);
+        DrawBackground(&background, (Vector2){ floorf(view.x / CELL_SIZE) * CELL_SIZE, floorf(view.y / CELL_SIZE) * CELL_SIZE });
+        if (!snap->gameOver) DrawLevelEntities(&entities, snap, view, !bakeWalls);
+        EndMode2D();
 
-        if (state.gameOver) {
+        if (snap->gameOver) {
             DrawText("SYSTEM FAILURE", 250, 200, 40, RED);
             DrawText("PRESS ENTER TO REBOOT", 260, 260, 20, DARKGRAY);
-            DrawText(TextFormat("FINAL SCORE: %d", state.score), 320, 320, 20, WHITE);
+            DrawText(TextFormat("FINAL SCORE: %d", snap->score), 320, 320, 20, WHITE);
         } else {
-            // Draw Entities
-            for (int i = 0; i < state.entityCount; i++) {
-                Entity* e = &state.entities[i];
-                if (!e->active) continue;
-
-                if (e->type == ENTITY_WALL) {
-                    DrawRectangleRec((Rectangle){e->position.x, e->position.y, e->size.x, e->size.y}, BLUE);
-                    DrawRectangleLinesEx((Rectangle){e->position.x, e->position.y, e->size.x, e->size.y}, 1, WHITE);
-                }
-                else if (e->type == ENTITY_APPLE) {
-                     DrawRectangleV(e->position, e->size, RED);
-                }
-                else if (e->type == ENTITY_COIN) {
-                     DrawRectangleV(e->position, e->size, GOLD);
-                }
-                else if (e->type == ENTITY_ENEMY_BASIC) {
-                     DrawRectangleV(e->position, e->size, PURPLE);
-                }
-                else if (e->type == ENTITY_SNAKE) {
-                    SnakeData* s = (SnakeData*)e->data;
-                    for(int j=0; j<s->count; j++) {
-                        Color col = (j == 0) ? GREEN : DARKGREEN; 
-                        DrawRectangleV(s->body[j], e->size, col);
-                    }
-                }
-            }
             // UI
-            DrawText(TextFormat("SCORE: %d / %d", state.score, state.levelTargetScore), 10, 10, 20, GREEN);
+            DrawText(TextFormat("LEVEL %d  SCORE: %d / %d", snap->currentLevel, snap->score, snap->levelStartScore + snap->levelTargetScore), 10, 10, 20, GREEN);
+            if (snap->targetReached) DrawText("TARGET REACHED!", 200, 200, 40, GREEN);
         }
 
         EndDrawing();
     }
 
+    UnloadBackground(&background);
+    UnloadEntityRenderer(&entities);
+    StopSimulation(&sim);
+    FreeLevelPacks();
+    ENGINE_FREE(packed);
     CloseWindow();
     return 0;
 }
\ No newline at end of file
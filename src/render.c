@@ -0,0 +1,288 @@
+#include "render.h"
+#include "rlgl.h"
+#include "raymath.h"
+#include <stddef.h>
+#include <math.h>
+
+// rlSetVertexAttribute takes its offset as an int from raylib 5.5 on (a
+// pointer before), and GetShapesTextureRectangle is new in 5.5
+#if RAYLIB_VERSION_MAJOR < 5 || (RAYLIB_VERSION_MAJOR == 5 && RAYLIB_VERSION_MINOR < 5)
+#error "the game and editor need raylib 5.5 or newer"
+#endif
+
+// --- BACKGROUND ---
+static bool SameColor(Color a, Color b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+static bool SameGrid(GridStyle a, GridStyle b) {
+    return a.width == b.width && a.height == b.height && a.cellSize == b.cellSize &&
+           SameColor(a.fill, b.fill) && SameColor(a.line, b.line);
+}
+
+// Everything is drawn over an opaque fill, so the texture holds the final
+// pixels and compositing it needs no blending tricks.
+static void BakeBackground(const BackgroundLayer* bg, const RenderSnapshot* walls) {
+    GridStyle g = bg->grid;
+    BeginTextureMode(bg->target);
+    ClearBackground(g.fill);
+    for (int i = 0; i < g.width; i += g.cellSize) DrawLine(i, 0, i, g.height, g.line);
+    for (int i = 0; i < g.height; i += g.cellSize) DrawLine(0, i, g.width, i, g.line);
+
+    for (int i = 0; walls && i < walls->count; i++) {
+        if (walls->types[i] != ENTITY_WALL) continue;
+        Rectangle r = { walls->positions[i].x, walls->positions[i].y, walls->sizes[i].x, walls->sizes[i].y };
+        DrawRectangleRec(r, BLUE);
+        DrawRectangleLinesEx(r, 1, WHITE);
+    }
+    EndTextureMode();
+}
+
+// Call outside BeginDrawing/EndDrawing
+void UpdateBackground(BackgroundLayer* bg, GridStyle grid, const RenderSnapshot* walls) {
+    bool resized = bg->target.id == 0 || grid.width != bg->grid.width || grid.height != bg->grid.height;
+    bool dirty = resized || !SameGrid(grid, bg->grid) || (walls != NULL) != bg->hasWalls ||
+                 (walls && (walls->level != bg->level || walls->wallRevision != bg->wallRevision));
+    if (!dirty) return;
+
+    if (resized) {
+        if (bg->target.id != 0) UnloadRenderTexture(bg->target);
+        bg->target = LoadRenderTexture(grid.width, grid.height);
+    }
+    bg->grid = grid;
+    bg->hasWalls = walls != NULL;
+    bg->level = walls ? walls->level : 0;
+    bg->wallRevision = walls ? walls->wallRevision : 0;
+    BakeBackground(bg, walls);
+}
+
+void DrawBackground(const BackgroundLayer* bg, Vector2 position) {
+    // Render textures are stored bottom-up
+    Texture2D t = bg->target.texture;
+    DrawTextureRec(t, (Rectangle){0, 0, (float)t.width, (float)-t.height}, position, WHITE);
+}
+
+void UnloadBackground(BackgroundLayer* bg) {
+    if (bg->target.id != 0) UnloadRenderTexture(bg->target);
+    *bg = (BackgroundLayer){0};
+}
+
+// --- ENTITY BATCHES ---
+#define QUADS_PER_CHECK 1024    // Quads written between rlgl batch-limit checks
+
+static const char* quadVertexShader =
+    "#version 330\n"
+    "in vec2 vertexPosition;\n"   // Unit quad corner
+    "in vec4 instanceRect;\n"     // x, y, width, height
+    "in vec4 instanceColor;\n"
+    "uniform mat4 mvp;\n"
+    "out vec4 fragColor;\n"
+    "void main() {\n"
+    "    fragColor = instanceColor;\n"
+    "    gl_Position = mvp * vec4(instanceRect.xy + vertexPosition * instanceRect.zw, 0.0, 1.0);\n"
+    "}\n";
+
+static const char* quadFragmentShader =
+    "#version 330\n"
+    "in vec4 fragColor;\n"
+    "out vec4 finalColor;\n"
+    "void main() {\n"
+    "    finalColor = fragColor;\n"
+    "}\n";
+
+// Falls back to the rlgl batch when the GL version, the shader or its
+// attributes aren't there
+void InitEntityRenderer(EntityRenderer* r) {
+    *r = (EntityRenderer){0};
+    int version = rlGetVersion();
+    if (version != RL_OPENGL_33 && version != RL_OPENGL_43) return;
+
+    // A failed compile hands back raylib's default shader, which lacks our attributes
+    r->shader = LoadShaderFromMemory(quadVertexShader, quadFragmentShader);
+    int cornerLoc = GetShaderLocationAttrib(r->shader, "vertexPosition");
+    r->rectLoc = GetShaderLocationAttrib(r->shader, "instanceRect");
+    r->colorLoc = GetShaderLocationAttrib(r->shader, "instanceColor");
+    r->mvpLoc = GetShaderLocation(r->shader, "mvp");
+    if (cornerLoc < 0 || r->rectLoc < 0 || r->colorLoc < 0 || r->mvpLoc < 0) {
+        UnloadShader(r->shader);
+        r->shader = (Shader){0};
+        return;
+    }
+
+    // Two triangles over the unit square
+    static const float corners[12] = { 0, 0,  0, 1,  1, 1,  0, 0,  1, 1,  1, 0 };
+    r->vao = rlLoadVertexArray();
+    if (!rlEnableVertexArray(r->vao)) {
+        UnloadShader(r->shader);
+        r->shader = (Shader){0};
+        return;
+    }
+    r->cornerVbo = rlLoadVertexBuffer(corners, sizeof(corners), false);
+    rlSetVertexAttribute(cornerLoc, 2, RL_FLOAT, false, 0, 0);
+    rlEnableVertexAttribute(cornerLoc);
+    rlDisableVertexArray();
+    r->instanced = true;
+}
+
+static bool ReserveQuads(QuadBatch* b, int extra) {
+    int needed = b->count + extra;
+    if (needed <= b->capacity) return true;
+    int capacity = b->capacity ? b->capacity : 256;
+    while (capacity < needed) capacity *= 2;
+    QuadInstance* items = (QuadInstance*)realloc(b->items, (size_t)capacity * sizeof(QuadInstance));
+    if (!items) return false;
+    b->items = items;
+    b->capacity = capacity;
+    return true;
+}
+
+static void PushQuad(QuadBatch* b, Vector2 pos, Vector2 size, Color color) {
+    if (b->count == b->capacity && !ReserveQuads(b, 1)) return;
+    b->items[b->count++] = (QuadInstance){ pos.x, pos.y, size.x, size.y, color };
+}
+
+typedef struct QuadGather {
+    EntityRenderer* r;
+    const RenderSnapshot* snap;
+    bool walls;
+} QuadGather;
+
+static void GatherEntity(void* user, int index) {
+    QuadGather* g = (QuadGather*)user;
+    Vector2 pos = g->snap->positions[index];
+    Vector2 size = g->snap->sizes[index];
+    switch (g->snap->types[index]) {
+        case ENTITY_WALL:
+            if (!g->walls) break;
+            // A 1px outline is the white quad left showing around the fill
+            PushQuad(&g->r->batches[RENDER_WALLS], pos, size, WHITE);
+            if (size.x > 2 && size.y > 2) {
+                PushQuad(&g->r->batches[RENDER_WALLS], (Vector2){pos.x + 1, pos.y + 1}, (Vector2){size.x - 2, size.y - 2}, BLUE);
+            }
+            break;
+        case ENTITY_APPLE:       PushQuad(&g->r->batches[RENDER_PICKUPS], pos, size, RED); break;
+        case ENTITY_COIN:        PushQuad(&g->r->batches[RENDER_PICKUPS], pos, size, GOLD); break;
+        case ENTITY_ENEMY_BASIC: PushQuad(&g->r->batches[RENDER_ENEMIES], pos, size, PURPLE); break;
+        default: break;
+    }
+}
+
+// Consecutive segments are at most a cell apart on each axis (a move is one
+// cell, growth stacks on the tail), so a segment n cells clear of the view
+// means the next n can't reach it either and are skipped. A long snake costs
+// what's on screen plus one probe per cell of distance to it.
+static void GatherSnake(QuadBatch* b, const Vector2* body, int count, Vector2 size, Rectangle view) {
+    for (int i = 0; i < count; ) {
+        Vector2 p = body[i];
+        float gapX = fmaxf(view.x - (p.x + size.x), p.x - (view.x + view.width));
+        float gapY = fmaxf(view.y - (p.y + size.y), p.y - (view.y + view.height));
+        float gap = fmaxf(gapX, gapY);
+        if (gap < 0) {
+            PushQuad(b, p, size, i == 0 ? GREEN : DARKGREEN);
+            i++;
+        } else {
+            i += (int)(gap / CELL_SIZE) + 1;
+        }
+    }
+}
+
+static void GatherQuads(EntityRenderer* r, const RenderSnapshot* snap, Rectangle view, bool walls) {
+    for (int k = 0; k < RENDER_BATCH_COUNT; k++) r->batches[k].count = 0;
+
+    UpdateSpatialIndex(&r->index, snap);
+    QuadGather g = { r, snap, walls };
+    QuerySpatialIndex(&r->index, snap, (Vector2){view.x, view.y}, (Vector2){view.width, view.height}, GatherEntity, &g);
+
+    for (int c = 0; c < snap->snakeCount; c++) {
+        const SnapshotSnake* s = &snap->snakes[c];
+        GatherSnake(&r->batches[RENDER_SNAKES], &snap->segments[s->first], s->count, s->size, view);
+    }
+}
+
+static void ReserveInstances(EntityRenderer* r, int count) {
+    if (count <= r->instanceCapacity) return;
+    int capacity = r->instanceCapacity ? r->instanceCapacity : 1024;
+    while (capacity < count) capacity *= 2;
+
+    rlEnableVertexArray(r->vao);
+    if (r->instanceVbo) rlUnloadVertexBuffer(r->instanceVbo);
+    r->instanceVbo = rlLoadVertexBuffer(NULL, capacity * (int)sizeof(QuadInstance), true);
+    rlSetVertexAttribute(r->rectLoc, 4, RL_FLOAT, false, sizeof(QuadInstance), (int)offsetof(QuadInstance, x));
+    rlSetVertexAttributeDivisor(r->rectLoc, 1);
+    rlEnableVertexAttribute(r->rectLoc);
+    rlSetVertexAttribute(r->colorLoc, 4, RL_UNSIGNED_BYTE, true, sizeof(QuadInstance), (int)offsetof(QuadInstance, color));
+    rlSetVertexAttributeDivisor(r->colorLoc, 1);
+    rlEnableVertexAttribute(r->colorLoc);
+    rlDisableVertexArray();
+    r->instanceCapacity = capacity;
+}
+
+// All batches back to back in one buffer, then one draw call
+static void DrawQuadsInstanced(EntityRenderer* r) {
+    int total = 0;
+    for (int k = 0; k < RENDER_BATCH_COUNT; k++) total += r->batches[k].count;
+    if (total == 0) return;
+    ReserveInstances(r, total);
+
+    int offset = 0;
+    for (int k = 0; k < RENDER_BATCH_COUNT; k++) {
+        const QuadBatch* b = &r->batches[k];
+        if (b->count == 0) continue;
+        rlUpdateVertexBuffer(r->instanceVbo, b->items, b->count * (int)sizeof(QuadInstance), offset * (int)sizeof(QuadInstance));
+        offset += b->count;
+    }
+
+    // Whatever raylib has queued so far belongs underneath
+    rlDrawRenderBatchActive();
+    rlEnableShader(r->shader.id);
+    rlSetUniformMatrix(r->mvpLoc, MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+    rlEnableVertexArray(r->vao);
+    rlDrawVertexArrayInstanced(0, 6, total);
+    rlDisableVertexArray();
+    rlDisableShader();
+}
+
+// Same quads DrawRectangleRec emits, without its per-call setup
+static void DrawQuadsBatched(const QuadBatch* b) {
+    if (b->count == 0) return;
+    Texture2D shapes = GetShapesTexture();
+    Rectangle src = GetShapesTextureRectangle();
+    float u0 = src.x / shapes.width, v0 = src.y / shapes.height;
+    float u1 = (src.x + src.width) / shapes.width, v1 = (src.y + src.height) / shapes.height;
+
+    rlSetTexture(shapes.id);
+    rlBegin(RL_QUADS);
+    rlNormal3f(0.0f, 0.0f, 1.0f);
+    for (int i = 0; i < b->count; i++) {
+        if (i % QUADS_PER_CHECK == 0) rlCheckRenderBatchLimit(4 * QUADS_PER_CHECK);
+        const QuadInstance* q = &b->items[i];
+        rlColor4ub(q->color.r, q->color.g, q->color.b, q->color.a);
+        rlTexCoord2f(u0, v0); rlVertex2f(q->x, q->y);
+        rlTexCoord2f(u0, v1); rlVertex2f(q->x, q->y + q->height);
+        rlTexCoord2f(u1, v1); rlVertex2f(q->x + q->width, q->y + q->height);
+        rlTexCoord2f(u1, v0); rlVertex2f(q->x + q->width, q->y);
+    }
+    rlEnd();
+    rlSetTexture(0);
+}
+
+// Only what overlaps view (world space) is submitted. Walls are skipped when
+// they're baked into the background.
+void DrawLevelEntities(EntityRenderer* r, const RenderSnapshot* snap, Rectangle view, bool walls) {
+    GatherQuads(r, snap, view, walls);
+    if (r->instanced) {
+        DrawQuadsInstanced(r);
+    } else {
+        for (int k = 0; k < RENDER_BATCH_COUNT; k++) DrawQuadsBatched(&r->batches[k]);
+    }
+}
+
+void UnloadEntityRenderer(EntityRenderer* r) {
+    for (int k = 0; k < RENDER_BATCH_COUNT; k++) free(r->batches[k].items);
+    FreeSpatialIndex(&r->index);
+    if (r->instanceVbo) rlUnloadVertexBuffer(r->instanceVbo);
+    if (r->cornerVbo) rlUnloadVertexBuffer(r->cornerVbo);
+    if (r->vao) rlUnloadVertexArray(r->vao);
+    if (r->instanced) UnloadShader(r->shader);
+    *r = (EntityRenderer){0};
+}
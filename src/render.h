@@ -0,0 +1,79 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "raylib.h"
+#include "game_types.h"
+
+// --- RENDERING ---
+// Drawing shared by the game and the editor. Needs raylib, so it's linked
+// into those two and kept out of the engine library.
+
+typedef struct GridStyle {
+    int width, height;          // Pixels covered
+    int cellSize;
+    Color fill;                 // Under the lines
+    Color line;
+} GridStyle;
+
+// The grid, and optionally a level's walls, baked into one texture that a
+// frame draws as a single quad. The texture is only reallocated when the
+// grid's size changes and only redrawn when the style or the walls do.
+// Snapshots come and go every tick, so the walls are keyed by level serial
+// and revision rather than by pointer.
+typedef struct BackgroundLayer {
+    RenderTexture2D target;
+    GridStyle grid;             // Style the texture was baked with
+    bool hasWalls;
+    unsigned int level;         // RenderSnapshot.level of the baked walls
+    unsigned int wallRevision;
+} BackgroundLayer;
+
+void UpdateBackground(BackgroundLayer* bg, GridStyle grid, const RenderSnapshot* walls);
+void DrawBackground(const BackgroundLayer* bg, Vector2 position);
+void UnloadBackground(BackgroundLayer* bg);
+
+// --- ENTITY BATCHES ---
+// Every entity is a coloured rectangle, so each kind is gathered into one
+// array of quads: the static ones from a spatial query over the view, snake
+// segments from their unrolled bodies. With GL 3.3 all of them go out as a
+// single instanced draw of a unit quad; otherwise they are written into
+// rlgl's vertex batch in one pass. Everything is read from a RenderSnapshot,
+// never from a live GameState.
+typedef struct QuadInstance {
+    float x, y, width, height;
+    Color color;
+} QuadInstance;
+
+typedef struct QuadBatch {
+    QuadInstance* items;
+    int count;
+    int capacity;
+} QuadBatch;
+
+// Batches in draw order
+typedef enum RenderBatch {
+    RENDER_WALLS,
+    RENDER_PICKUPS,
+    RENDER_ENEMIES,
+    RENDER_SNAKES,
+    RENDER_BATCH_COUNT
+} RenderBatch;
+
+typedef struct EntityRenderer {
+    QuadBatch batches[RENDER_BATCH_COUNT];
+    SpatialIndex index;         // Everything but snakes, for culling to the view
+    bool instanced;             // false: quads go through rlgl's batch instead
+    Shader shader;
+    int mvpLoc;
+    int rectLoc, colorLoc;      // Per-instance vertex attributes
+    unsigned int vao;
+    unsigned int cornerVbo;     // The unit quad every instance shares
+    unsigned int instanceVbo;
+    int instanceCapacity;       // Instances instanceVbo holds
+} EntityRenderer;
+
+void InitEntityRenderer(EntityRenderer* r);  // After InitWindow
+void DrawLevelEntities(EntityRenderer* r, const RenderSnapshot* snap, Rectangle view, bool walls);
+void UnloadEntityRenderer(EntityRenderer* r);
+
+#endif
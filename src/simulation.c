@@ -0,0 +1,228 @@
+#include "game_types.h"
+#include <string.h>
+#include <time.h>
+
+#define SIM_TICK_NS (1000000000LL / SIM_TICK_RATE)
+
+// --- RENDER SNAPSHOTS ---
+static bool ReserveSnapshot(RenderSnapshot* snap, int count, int segments) {
+    if (count > snap->capacity) {
+        int capacity = snap->capacity ? snap->capacity : 256;
+        while (capacity < count) capacity *= 2;
+        Vector2* positions = (Vector2*)ENGINE_REALLOC(snap->positions, (size_t)capacity * sizeof(Vector2));
+        if (!positions) return false;
+        snap->positions = positions;
+        Vector2* sizes = (Vector2*)ENGINE_REALLOC(snap->sizes, (size_t)capacity * sizeof(Vector2));
+        if (!sizes) return false;
+        snap->sizes = sizes;
+        EntityType* types = (EntityType*)ENGINE_REALLOC(snap->types, (size_t)capacity * sizeof(EntityType));
+        if (!types) return false;
+        snap->types = types;
+        snap->capacity = capacity;
+    }
+    if (segments > snap->segmentCapacity) {
+        int capacity = snap->segmentCapacity ? snap->segmentCapacity : 256;
+        while (capacity < segments) capacity *= 2;
+        Vector2* items = (Vector2*)ENGINE_REALLOC(snap->segments, (size_t)capacity * sizeof(Vector2));
+        if (!items) return false;
+        snap->segments = items;
+        snap->segmentCapacity = capacity;
+    }
+    return true;
+}
+
+// Copies out what drawing needs. Returns false if it ran out of memory; the
+// snapshot is then incomplete and mustn't be published. level is left to the
+// caller.
+bool CaptureSnapshot(RenderSnapshot* snap, const GameState* state) {
+    int segments = 0;
+    for (int c = 0; c < state->snakeCount; c++) {
+        if (state->snakes[c].body) segments += state->snakes[c].count;
+    }
+    if (!ReserveSnapshot(snap, state->aliveCount, segments)) return false;
+
+    for (int k = 0; k < state->aliveCount; k++) {
+        int id = state->alive[k];
+        snap->positions[k] = state->positions[id];
+        snap->sizes[k] = state->sizes[id];
+        snap->types[k] = state->types[id];
+    }
+    snap->count = state->aliveCount;
+
+    int n = 0;
+    snap->snakeCount = 0;
+    for (int c = 0; c < state->snakeCount; c++) {
+        const SnakeData* s = &state->snakes[c];
+        if (!s->body) continue;
+        snap->snakes[snap->snakeCount++] = (SnapshotSnake){ n, s->count, state->sizes[state->snakeOwner[c]] };
+        n += CopySnakeSegments(s, &snap->segments[n]);
+    }
+    snap->segmentCount = n;
+
+    snap->tick = state->tick;
+    snap->wallRevision = state->wallRevision;
+    snap->layoutRevision = state->layoutRevision;
+    snap->worldSize = state->worldSize;
+    snap->currentLevel = state->currentLevel;
+    snap->score = state->score;
+    snap->levelStartScore = state->levelStartScore;
+    snap->levelTargetScore = state->levelTargetScore;
+    snap->gameOver = state->gameOver;
+    snap->targetReached = CheckLevelProgression(state);
+    return true;
+}
+
+void FreeSnapshot(RenderSnapshot* snap) {
+    ENGINE_FREE(snap->positions);
+    ENGINE_FREE(snap->sizes);
+    ENGINE_FREE(snap->types);
+    ENGINE_FREE(snap->segments);
+    *snap = (RenderSnapshot){0};
+}
+
+// --- TRIPLE BUFFER ---
+static void InitSnapshotBuffer(SnapshotBuffer* b) {
+    memset(b->slots, 0, sizeof(b->slots));
+    b->back = 0;
+    atomic_init(&b->middle, 1);
+    b->front = 2;
+}
+
+// Simulation side: the back slot becomes the newest snapshot
+static void PublishSnapshot(SnapshotBuffer* b) {
+    int old = atomic_exchange_explicit(&b->middle, b->back | SNAPSHOT_FRESH, memory_order_acq_rel);
+    b->back = old & ~SNAPSHOT_FRESH;
+}
+
+// Renderer side: trade up to the newest snapshot if there is one
+static const RenderSnapshot* AcquireSnapshot(SnapshotBuffer* b) {
+    if (atomic_load_explicit(&b->middle, memory_order_relaxed) & SNAPSHOT_FRESH) {
+        int old = atomic_exchange_explicit(&b->middle, b->front, memory_order_acq_rel);
+        b->front = old & ~SNAPSHOT_FRESH;
+    }
+    return &b->slots[b->front];
+}
+
+// --- COMMAND QUEUE ---
+// Renderer only. False when the queue is full; the command is dropped.
+bool PushSimCommand(SimCommandQueue* q, SimCommand c) {
+    unsigned int tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&q->head, memory_order_acquire);
+    if (tail - head == SIM_COMMAND_QUEUE) return false;
+    q->items[tail & (SIM_COMMAND_QUEUE - 1)] = c;
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+// Simulation only
+bool PopSimCommand(SimCommandQueue* q, SimCommand* c) {
+    unsigned int head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    if (head == tail) return false;
+    *c = q->items[head & (SIM_COMMAND_QUEUE - 1)];
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    return true;
+}
+
+// --- SIMULATION THREAD ---
+static long long MonotonicNanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void SleepUntilNanos(long long deadline) {
+    struct timespec ts = { (time_t)(deadline / 1000000000LL), (long)(deadline % 1000000000LL) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) {}
+}
+
+static void PublishLevel(Simulation* sim) {
+    const GameState* state = sim->levels.active;
+    if (state != sim->shown) {
+        sim->shown = state;
+        sim->level++;
+    }
+    RenderSnapshot* snap = &sim->snapshots.slots[sim->snapshots.back];
+    if (!CaptureSnapshot(snap, state)) return;  // The renderer keeps the last one
+    snap->level = sim->level;
+    PublishSnapshot(&sim->snapshots);
+}
+
+static void WatchCurrentLevel(Simulation* sim) {
+    WatchLevelFile(&sim->watcher, sim->levels.paths[sim->levels.current]);
+}
+
+static void* SimulationMain(void* arg) {
+    Simulation* sim = (Simulation*)arg;
+    InputFrame input = {0};
+    long long deadline = MonotonicNanos();
+
+    while (!atomic_load_explicit(&sim->quit, memory_order_relaxed)) {
+        // Latest turn wins; it is applied on the next step
+        SimCommand c;
+        while (PopSimCommand(&sim->commands, &c)) {
+            if (c.type == SIM_TURN) {
+                input.turn = c.turn;
+            } else if (c.type == SIM_RELOAD) {
+                ReloadCurrentLevel(&sim->levels);
+            } else if (c.type == SIM_RESTART && sim->levels.active->gameOver) {
+                if (RestartLevelSequence(&sim->levels)) WatchCurrentLevel(sim);
+            }
+        }
+        // Saving the level file (e.g. from the editor) reloads it in place
+        if (LevelFileChanged(&sim->watcher)) ReloadCurrentLevel(&sim->levels);
+
+        GameState* state = sim->levels.active;
+        if (!state->gameOver) {
+            StepWorld(state, input);
+            input = (InputFrame){0};
+
+            // The next level is normally prefetched already, so this is a swap
+            if (CheckLevelProgression(state) && AdvanceLevel(&sim->levels)) WatchCurrentLevel(sim);
+        }
+        PublishLevel(sim);
+
+        // Absolute deadlines keep the tick rate exact. After a long stall the
+        // backlog past MAX_STEPS_PER_FRAME ticks is dropped, not replayed.
+        deadline += SIM_TICK_NS;
+        long long now = MonotonicNanos();
+        if (now - deadline > MAX_STEPS_PER_FRAME * SIM_TICK_NS) deadline = now;
+        else if (deadline > now) SleepUntilNanos(deadline);
+    }
+    return NULL;
+}
+
+// Loads the first level on the calling thread, publishes its first snapshot
+// and starts ticking. sim must stay where it is until StopSimulation.
+bool StartSimulation(Simulation* sim, const char* const* paths, int count) {
+    memset(sim, 0, sizeof(*sim));
+    atomic_init(&sim->commands.head, 0);
+    atomic_init(&sim->commands.tail, 0);
+    atomic_init(&sim->quit, false);
+    InitSnapshotBuffer(&sim->snapshots);
+    if (!InitLevelSequence(&sim->levels, paths, count)) return false;
+    InitLevelWatcher(&sim->watcher);
+    WatchCurrentLevel(sim);
+
+    PublishLevel(sim);
+    if (pthread_create(&sim->thread, NULL, SimulationMain, sim) != 0) {
+        FreeLevelWatcher(&sim->watcher);
+        FreeLevelSequence(&sim->levels);
+        for (int k = 0; k < 3; k++) FreeSnapshot(&sim->snapshots.slots[k]);
+        return false;
+    }
+    return true;
+}
+
+// Renderer side. Valid until the next call.
+const RenderSnapshot* LatestSnapshot(Simulation* sim) {
+    return AcquireSnapshot(&sim->snapshots);
+}
+
+void StopSimulation(Simulation* sim) {
+    atomic_store(&sim->quit, true);
+    pthread_join(sim->thread, NULL);
+    FreeLevelWatcher(&sim->watcher);
+    FreeLevelSequence(&sim->levels);
+    for (int k = 0; k < 3; k++) FreeSnapshot(&sim->snapshots.slots[k]);
+}